@@ -0,0 +1,438 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+
+#include <mongo/client/dbclientinterface.h>
+#include <mongo/util/exit_code.h>
+#include <mongo/util/hex.h>
+
+#include "robomongo/core/engine/NativeQuery.h"
+#include "robomongo/core/engine/ScriptEngine.h"
+#include "robomongo/core/settings/ConnectionSettings.h"
+#include "robomongo/core/HexUtils.h"
+#include "robomongo/core/utils/BsonUtils.h"
+#include "robomongo/core/utils/DateUtils.h"
+#include "robomongo/core/utils/EscapeUtils.h"
+#include "robomongo/core/utils/NumberUtils.h"
+#include "robomongo/core/utils/StdUtils.h"
+#include "robomongo/gui/widgets/workarea/BsonTreeItem.h"
+#include "robomongo/shell/db/ptimeutil.h"
+
+namespace mongo {
+    extern bool isShell;
+    void logProcessDetailsForLogRotate() {}
+    void exitCleanly(ExitCode code) {}
+}
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    // Heap allocated with operator new by this process. Qt and mongo buffers
+    // allocated with malloc directly (QString, BSONObj) are not counted.
+    std::atomic<size_t> heapBytes(0);
+    std::atomic<size_t> heapAllocations(0);
+
+    template <typename F>
+    void measure(const std::string &name, int iterations, F func) {
+        Clock::time_point start = Clock::now();
+        for (int i = 0; i < iterations; ++i)
+            func();
+        double total = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+        std::cout << std::left << std::setw(48) << name
+                  << std::right << std::setw(12) << std::fixed << std::setprecision(2)
+                  << total / iterations << " us/op" << std::endl;
+    }
+}
+
+void *operator new(size_t size)
+{
+    heapBytes += size;
+    ++heapAllocations;
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+/**
+ * @brief Compares both paths of ScriptEngine::exec for the same statements: native
+ * (NativeQuery + MongoClient, taken when connection is passed) and JavaScript (statement,
+ * shellPrintHelper, capture of __objects and prepareResult, taken without connection).
+ * Requires running MongoDB: benchmarks <host:port> [database] [collection]
+ */
+void benchNativeQuery(const std::string &address, const std::string &dbName, const std::string &collection) {
+    const int batchSize = 50;
+    const int iterations = 200;
+
+    mongo::DBClientConnection connection;
+    std::string error;
+    if (!connection.connect(mongo::HostAndPort(address), "bench", error)) {
+        std::cout << "Cannot connect to " << address << ": " << error << std::endl;
+        return;
+    }
+
+    const std::string ns = dbName + "." + collection;
+    if (connection.count(ns) < batchSize) {
+        for (int i = 0; i < 1000; ++i)
+            connection.insert(ns, BSON("n" << i << "name" << "document" << "tags" << BSON_ARRAY("a" << "b" << "c")));
+    }
+
+    const std::pair<std::string, std::string> statements[] = {
+        std::make_pair("find()", "db." + collection + ".find({ n: { $gte: 10 } }).sort({ n: 1 }).limit(100)"),
+        std::make_pair("count()", "db." + collection + ".count({ n: { $gte: 10 } })"),
+        std::make_pair("aggregate()", "db." + collection + ".aggregate([{ $match: { n: { $gte: 10 } } }, { $sort: { n: 1 } }])")
+    };
+
+    measure("NativeQuery::parse", 10000, [&]() {
+        Robomongo::NativeQuery query;
+        Robomongo::NativeQuery::parse(statements[0].second, query);
+    });
+
+    Robomongo::ConnectionSettings settings(false);
+    Robomongo::ScriptEngine engine(&settings, 60);
+    engine.init(false, address, dbName);
+    engine.use(dbName);
+    engine.setBatchSize(batchSize);
+
+    for (const auto &named : statements) {
+        const std::string &statement = named.second;
+
+        // Both paths are checked once, so errors are not measured
+        Robomongo::MongoShellExecResult native = engine.exec(statement, dbName, &connection);
+        Robomongo::MongoShellExecResult script = engine.exec(statement, dbName);
+        if (native.error() || script.error()) {
+            std::cout << statement << " failed: " << native.errorMessage() << script.errorMessage() << std::endl;
+            continue;
+        }
+
+        measure(named.first + " through ScriptEngine::exec, native", iterations, [&]() {
+            engine.exec(statement, dbName, &connection);
+        });
+
+        measure(named.first + " through ScriptEngine::exec, JavaScript", iterations, [&]() {
+            engine.exec(statement, dbName);
+        });
+    }
+}
+
+/**
+ * @brief Memory and construction time of BsonTreeArena for 100k-document result,
+ * with first level of every document populated (as done by BsonTreeModel).
+ */
+void benchBsonTree() {
+    const int documentsCount = 100 * 1000;
+
+    std::vector<mongo::BSONObj> objs;
+    objs.reserve(documentsCount);
+    for (int i = 0; i < documentsCount; ++i) {
+        mongo::OID id = mongo::OID::gen();
+        objs.push_back(BSON("_id" << id << "n" << i << "name" << "document" << "price" << i * 0.5 <<
+                            "tags" << BSON_ARRAY("a" << "b" << "c") << "address" << BSON("city" << "Moscow" << "zip" << 101000)));
+    }
+    std::shared_ptr<Robomongo::PreparedDocuments> documents = std::make_shared<Robomongo::PreparedDocuments>();
+    documents->_documents = objs;
+
+    size_t nodes = 0;
+    size_t bytes = 0;
+    size_t allocations = 0;
+    measure("BsonTreeArena, 100k documents + first level", 10, [&]() {
+        const size_t bytesBefore = heapBytes;
+        const size_t allocationsBefore = heapAllocations;
+
+        Robomongo::BsonTreeArena arena(documents, Robomongo::DefaultEncoding, Robomongo::Utc);
+        arena.fetchDocuments(arena.documentsCount());
+        for (int i = 0; i < arena.documentsCount(); ++i)
+            arena.populate(arena.document(i));
+        nodes = arena.fetchedDocumentsCount() + arena.itemsCount();
+
+        bytes = heapBytes - bytesBefore;
+        allocations = heapAllocations - allocationsBefore;
+    });
+
+    std::cout << "    nodes: " << nodes << ", " << sizeof(Robomongo::BsonTreeItem) << " bytes per node, "
+              << std::fixed << std::setprecision(2)
+              << bytes / (1024.0 * 1024.0) << " MB heap in " << allocations << " allocations" << std::endl;
+
+    Robomongo::BsonTreeArena arena(documents, Robomongo::DefaultEncoding, Robomongo::Utc);
+    arena.fetchDocuments(arena.documentsCount());
+    for (int i = 0; i < arena.documentsCount(); ++i)
+        arena.populate(arena.document(i));
+
+    // Cost of one screen of rows, strings are built only when view asks for them
+    measure("key() + value() of 50 rows", 1000, [&]() {
+        for (int i = 0; i < 50; ++i) {
+            Robomongo::BsonTreeItem *item = arena.document(i)->child(1);
+            item->key();
+            item->value();
+        }
+    });
+
+    measure("parent() + row() of 50 rows", 1000, [&]() {
+        int sum = 0;
+        for (int i = 0; i < 50; ++i) {
+            Robomongo::BsonTreeItem *item = arena.document(i)->child(5);
+            sum += item->parent()->row() + item->row();
+        }
+        volatile int result = sum;
+    });
+}
+
+/**
+ * @brief Sort of 1M-row table column (same comparison as BsonTableModel::sort uses for non-strings)
+ */
+void benchTableSort() {
+    const int rowsCount = 1000 * 1000;
+
+    std::vector<mongo::BSONObj> docs;
+    docs.reserve(rowsCount);
+    for (int i = 0; i < rowsCount; ++i) {
+        if (i % 3 == 0)
+            docs.push_back(BSON("v" << (i * 7919) % 100003));
+        else
+            docs.push_back(BSON("v" << ((i * 104729) % 1000003) * 0.5));
+    }
+
+    measure("parallelSort() of 1M numeric values", 5, [&]() {
+        std::vector<mongo::BSONElement> elements(rowsCount);
+        Robomongo::stdutils::parallelFor(rowsCount, 4096, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+                elements[i] = docs[i].firstElement();
+        });
+
+        Robomongo::stdutils::parallelSort(elements.begin(), elements.end(),
+            [](const mongo::BSONElement &a, const mongo::BSONElement &b) {
+                return a.woCompare(b, false) < 0;
+            });
+    });
+}
+
+/**
+ * @brief JSON of deep, wide and array-heavy documents: jsonString() that returns new
+ * string vs writeJson() that appends to one reused buffer
+ */
+void benchJsonString() {
+    mongo::BSONObj deep = BSON("value" << "leaf" << "n" << 1);
+    for (int i = 0; i < 100; ++i)
+        deep = BSON("level" << i << "name" << "node" << "child" << deep);
+
+    mongo::BSONObjBuilder wideBuilder;
+    for (int i = 0; i < 1000; ++i) {
+        std::string name = "field" + std::to_string(i);
+        if (i % 2)
+            wideBuilder.append(name, "value of field " + std::to_string(i));
+        else
+            wideBuilder.append(name, i * 1.5);
+    }
+    mongo::BSONObj wide = wideBuilder.obj();
+
+    mongo::BSONArrayBuilder arrayBuilder;
+    for (int i = 0; i < 10000; ++i)
+        arrayBuilder.append(i % 3 ? mongo::BSONObj() : BSON("i" << i));
+    for (int i = 0; i < 10000; ++i)
+        arrayBuilder.append(i);
+    mongo::BSONObj arrays = BSON("items" << arrayBuilder.arr());
+
+    const std::pair<const char *, mongo::BSONObj> documents[] = {
+        std::make_pair("deep (100 levels)", deep),
+        std::make_pair("wide (1000 fields)", wide),
+        std::make_pair("array-heavy (20k elements)", arrays)
+    };
+
+    for (const auto &document : documents) {
+        measure(std::string("jsonString(), ") + document.first, 200, [&]() {
+            std::string json = Robomongo::BsonUtils::jsonString(document.second, Robomongo::BsonUtils::TenGenJson, 1,
+                                                                 Robomongo::DefaultEncoding, Robomongo::Utc);
+        });
+
+        std::string buffer;
+        measure(std::string("writeJson() to reused buffer, ") + document.first, 200, [&]() {
+            buffer.clear();
+            Robomongo::BsonUtils::writeJson(buffer, document.second, Robomongo::BsonUtils::TenGenJson, 1,
+                                            Robomongo::DefaultEncoding, Robomongo::Utc);
+        });
+    }
+}
+
+/**
+ * @brief Escaping of long text fields (1 MB) with every kernel supported by CPU
+ */
+void benchEscape() {
+    using namespace Robomongo::EscapeUtils;
+
+    std::string ascii;
+    while (ascii.size() < 1024 * 1024)
+        ascii += "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor "
+                 "incididunt ut labore et dolore magna aliqua. \"Ut enim\" ad minim veniam.\n";
+
+    std::string cyrillic;
+    while (cyrillic.size() < 1024 * 1024)
+        cyrillic += "\xD0\xA1\xD1\x8A\xD0\xB5\xD1\x88\xD1\x8C \xD0\xB6\xD0\xB5 \xD0\xB5\xD1\x89\xD1\x91 "
+                    "\xD1\x8D\xD1\x82\xD0\xB8\xD1\x85 \xD0\xBC\xD1\x8F\xD0\xB3\xD0\xBA\xD0\xB8\xD1\x85 "
+                    "\xD1\x84\xD1\x80\xD0\xB0\xD0\xBD\xD1\x86\xD1\x83\xD0\xB7\xD1\x81\xD0\xBA\xD0\xB8\xD1\x85 "
+                    "\xD0\xB1\xD1\x83\xD0\xBB\xD0\xBE\xD0\xBA. ";
+
+    const Kernel kernels[] = { ScalarKernel, Sse2Kernel, Avx2Kernel };
+    std::string out;
+    for (size_t i = 0; i <= supportedKernel(); ++i) {
+        measure(std::string("appendEscaped() 1 MB ASCII, ") + kernelName(kernels[i]), 100, [&]() {
+            out.clear();
+            appendEscaped(out, ascii.data(), ascii.size(), false, kernels[i]);
+        });
+        measure(std::string("appendEscaped() 1 MB Cyrillic, ") + kernelName(kernels[i]), 100, [&]() {
+            out.clear();
+            appendEscaped(out, cyrillic.data(), cyrillic.size(), false, kernels[i]);
+        });
+    }
+}
+
+/**
+ * @brief Formatting of 100k numbers: shortest round-trip doubles and digit pairs for
+ * integers vs stream conversion with precision (as was done before)
+ */
+void benchNumbers() {
+    std::vector<double> doubles;
+    std::vector<long long> longs;
+    for (int i = 0; i < 100 * 1000; ++i) {
+        doubles.push_back((i * 7919 % 100003) * 0.01 + i);
+        longs.push_back(static_cast<long long>(i) * 1000003 * (i % 2 ? 1 : -1));
+    }
+
+    std::string out;
+    measure("appendDouble() of 100k doubles", 20, [&]() {
+        out.clear();
+        for (size_t i = 0; i < doubles.size(); ++i)
+            Robomongo::NumberUtils::appendDouble(out, doubles[i]);
+    });
+
+    measure("stringstream of 100k doubles", 20, [&]() {
+        out.clear();
+        for (size_t i = 0; i < doubles.size(); ++i) {
+            std::stringstream s;
+            s.precision(std::numeric_limits<double>::digits10);
+            s << doubles[i];
+            out += s.str();
+        }
+    });
+
+    measure("appendInteger() of 100k longs", 20, [&]() {
+        out.clear();
+        for (size_t i = 0; i < longs.size(); ++i)
+            Robomongo::NumberUtils::appendInteger(out, longs[i]);
+    });
+
+    measure("sprintf() of 100k longs", 20, [&]() {
+        out.clear();
+        for (size_t i = 0; i < longs.size(); ++i) {
+            char num[32] = {0};
+            sprintf(num, "%lld", longs[i]);
+            out.append(num);
+        }
+    });
+}
+
+/**
+ * @brief Formatting of 100k dates spread over 50 years, UTC and local time: civil date
+ * from days and cached offsets vs boost::posix_time (as was done before)
+ */
+void benchDates() {
+    std::vector<long long> dates;
+    for (int i = 0; i < 100 * 1000; ++i)
+        dates.push_back(946684800000LL + static_cast<long long>(i) * 15768000013LL % 1576800000000LL);
+
+    std::string out;
+    for (int local = 0; local < 2; ++local) {
+        const std::string zone = local ? " (local)" : " (UTC)";
+
+        measure("appendIsoDate() of 100k dates" + zone, 20, [&]() {
+            out.clear();
+            for (size_t i = 0; i < dates.size(); ++i)
+                Robomongo::DateUtils::appendIsoDate(out, dates[i], true, local != 0);
+        });
+
+        measure("isotimeString() of 100k dates" + zone, 20, [&]() {
+            out.clear();
+            boost::posix_time::ptime epoch(boost::gregorian::date(1970, 1, 1));
+            for (size_t i = 0; i < dates.size(); ++i)
+                out.append(miutil::isotimeString(epoch + boost::posix_time::millisec(dates[i]), true, local != 0));
+        });
+    }
+}
+
+/**
+ * @brief Formatting of 100k legacy Java UUIDs from raw bytes vs hex string and
+ * substrings (as was done before), hex of 1 MB of binary data
+ */
+void benchUuid() {
+    std::vector<mongo::BSONObj> uuids;
+    for (int i = 0; i < 100 * 1000; ++i) {
+        char bytes[16];
+        for (int j = 0; j < 16; ++j)
+            bytes[j] = static_cast<char>(i * 31 + j * 7);
+        mongo::BSONObjBuilder builder;
+        builder.appendBinData("uuid", 16, mongo::bdtUUID, bytes);
+        uuids.push_back(builder.obj());
+    }
+
+    std::string out;
+    measure("appendUuid() of 100k UUIDs", 20, [&]() {
+        out.clear();
+        for (size_t i = 0; i < uuids.size(); ++i)
+            Robomongo::HexUtils::appendUuid(out, uuids[i].firstElement(), Robomongo::JavaLegacy);
+    });
+
+    measure("toHexLower() and hexToJavaUuid() of 100k UUIDs", 20, [&]() {
+        out.clear();
+        for (size_t i = 0; i < uuids.size(); ++i) {
+            int len;
+            const char *data = uuids[i].firstElement().binData(len);
+            std::string hex = mongo::toHexLower(data, len);
+            std::string msb = hex.substr(0, 16);
+            std::string lsb = hex.substr(16, 16);
+            msb = msb.substr(14, 2) + msb.substr(12, 2) + msb.substr(10, 2) + msb.substr(8, 2) + msb.substr(6, 2) + msb.substr(4, 2) + msb.substr(2, 2) + msb.substr(0, 2);
+            lsb = lsb.substr(14, 2) + lsb.substr(12, 2) + lsb.substr(10, 2) + lsb.substr(8, 2) + lsb.substr(6, 2) + lsb.substr(4, 2) + lsb.substr(2, 2) + lsb.substr(0, 2);
+            std::string temp = msb + lsb;
+            out += "JUUID(\"" + temp.substr(0, 8) + '-' + temp.substr(8, 4) + '-' + temp.substr(12, 4) + '-' + temp.substr(16, 4) + '-' + temp.substr(20, 12) + "\")";
+        }
+    });
+
+    const std::string binary(1024 * 1024, '\x9c');
+    measure("appendHexLower() of 1 MB", 20, [&]() {
+        out.clear();
+        Robomongo::HexUtils::appendHexLower(out, binary.data(), binary.size());
+    });
+
+    measure("mongo::toHexLower() of 1 MB", 20, [&]() {
+        out = mongo::toHexLower(binary.data(), binary.size());
+    });
+}
+
+int main(int argc, char *argv[], char** envp)
+{
+    benchBsonTree();
+    benchTableSort();
+    benchJsonString();
+    benchEscape();
+    benchNumbers();
+    benchDates();
+    benchUuid();
+
+    if (argc > 1)
+        benchNativeQuery(argv[1], argc > 2 ? argv[2] : "test", argc > 3 ? argv[3] : "robomongo_bench");
+
+    return 0;
+}
@@ -16,7 +16,7 @@ int main(int argc, char *argv[])
     m.append("test", 56);
     const mongo::BSONObj &obj = m.obj();
 
-    std::string str = BsonUtils::jsonString(obj, mongo::TenGen, 1, DefaultEncoding, Utc);
+    std::string str = BsonUtils::jsonString(obj, BsonUtils::TenGenJson, 1, DefaultEncoding, Utc);
 
     qDebug() << "Hello!";
     qDebug() << QString::fromStdString(str);
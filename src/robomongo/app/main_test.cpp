@@ -3,9 +3,29 @@
 #include <sstream>
 #include <iostream>
 #include <assert.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <limits>
+#include <random>
+#include <vector>
+#include <mongo/bson/bsonobjbuilder.h>
 #include <mongo/util/exit_code.h>
+#include <mongo/util/hex.h>
 #include <mongo/util/net/hostandport.h>
+#include <QDir>
+#include <QFile>
+
+#include "robomongo/core/HexUtils.h"
+#include "robomongo/core/domain/ResultWriter.h"
+#include "robomongo/core/utils/BsonUtils.h"
+#include "robomongo/core/utils/DateUtils.h"
+#include "robomongo/core/utils/EscapeUtils.h"
+#include "robomongo/core/utils/NumberUtils.h"
+#include "robomongo/core/utils/StdUtils.h"
+#include "robomongo/gui/editors/JsonLexer.h"
+#include "robomongo/shell/bson/json.h"
+#include "robomongo/shell/db/ptimeutil.h"
 
 namespace mongo {
     extern bool isShell;
@@ -68,9 +88,367 @@ void testPrecision() {
     precisionAssert("9.7", 9.7);
 }
 
+void testParallelSort() {
+    const size_t sizes[] = { 0, 1, 7, 100000, 1000003 };
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+        std::vector<int> values(sizes[i]);
+        for (size_t j = 0; j < values.size(); ++j)
+            values[j] = (j * 7919) % 1009;
+
+        std::vector<int> expected = values;
+        std::sort(expected.begin(), expected.end());
+
+        Robomongo::stdutils::parallelSort(values.begin(), values.end(), std::less<int>());
+        assert(values == expected);
+    }
+}
+
+void escapeAssert(const std::string &expected, const std::string &text, bool escapeSlash = false) {
+    using namespace Robomongo::EscapeUtils;
+    const Kernel kernels[] = { ScalarKernel, Sse2Kernel, Avx2Kernel };
+
+    // Text is padded so that special bytes are at every position of SIMD blocks
+    for (size_t padding = 0; padding < 40; ++padding) {
+        const std::string prefix(padding, 'x');
+        const std::string input = prefix + text + prefix;
+        for (size_t i = 0; i <= supportedKernel(); ++i) {
+            std::string out;
+            appendEscaped(out, input.data(), input.size(), escapeSlash, kernels[i]);
+            assert(out == prefix + expected + prefix);
+        }
+    }
+}
+
+void testEscape() {
+    escapeAssert("", "");
+    escapeAssert("plain text", "plain text");
+    escapeAssert("\\\"quoted\\\"", "\"quoted\"");
+    escapeAssert("a/b", "a/b");
+    escapeAssert("a\\/b", "a/b", true);
+    escapeAssert("\\b\\f\\n\\r\\t\\u0001\\u001f", "\b\f\n\r\t\x01\x1f");
+    escapeAssert("\x7f", "\x7f");
+    escapeAssert("\xD0\x96\xE2\x82\xAC\xF0\x9F\x98\x80", "\xD0\x96\xE2\x82\xAC\xF0\x9F\x98\x80");
+
+    // Every byte of invalid UTF-8 is replaced: stray continuation, overlong, surrogate, cut sequence
+    const std::string replacement = "\xEF\xBF\xBD";
+    escapeAssert(replacement + "a", "\x80" "a");
+    escapeAssert(replacement + replacement, "\xC0\xAF");
+    escapeAssert(replacement + replacement + replacement, "\xED\xA0\x80");
+    escapeAssert("a" + replacement + replacement, "a\xE2\x82");
+}
+
+void numberAssert(const std::string &text, double d) {
+    std::string out;
+    Robomongo::NumberUtils::appendDouble(out, d);
+    assert(out == text);
+}
+
+/**
+ * @brief Numbers written by BsonUtils::jsonString are parsed back by JParse
+ * to the same types and bit-exact values
+ */
+void roundTripAssert(const mongo::BSONObj &obj) {
+    std::string json = Robomongo::BsonUtils::jsonString(obj, Robomongo::BsonUtils::TenGenJson, 1, Robomongo::DefaultEncoding, Robomongo::Utc);
+    mongo::BSONObj parsed = mongo::Robomongo::fromjson(json);
+    assert(parsed.binaryEqual(obj));
+}
+
+void testNumberRoundTrip() {
+    numberAssert("0.0", 0.0);
+    numberAssert("-0.0", -0.0);
+    numberAssert("9.0", 9.0);
+    numberAssert("9.8", 9.8);
+    numberAssert("3.1415", 3.1415);
+    numberAssert("0.30000000000000004", 0.1 + 0.2);
+    numberAssert("9.987654321098764", 9.987654321098765);
+    numberAssert("1000000000000000.0", 1e15);
+    numberAssert("100000000000000000000.0", 1e20);
+    numberAssert("1e+21", 1e21);
+    numberAssert("0.000001", 1e-6);
+    numberAssert("1e-7", 1e-7);
+    numberAssert("-1.5e-7", -1.5e-7);
+    numberAssert("5e-324", std::numeric_limits<double>::denorm_min());
+    numberAssert("1.7976931348623157e+308", std::numeric_limits<double>::max());
+    numberAssert("NaN", std::numeric_limits<double>::quiet_NaN());
+    numberAssert("Infinity", std::numeric_limits<double>::infinity());
+    numberAssert("-Infinity", -std::numeric_limits<double>::infinity());
+
+    roundTripAssert(BSON("int" << 0 << "min" << std::numeric_limits<int>::min() << "max" << std::numeric_limits<int>::max()));
+    roundTripAssert(BSON("long" << 0LL << "min" << std::numeric_limits<long long>::min()
+                         << "max" << std::numeric_limits<long long>::max()));
+    roundTripAssert(BSON("decimal" << mongo::Decimal128("-1234.5678E-10") << "array" << BSON_ARRAY(1.0 << 2 << 3LL)));
+    roundTripAssert(BSON("nan" << std::numeric_limits<double>::quiet_NaN()
+                         << "inf" << std::numeric_limits<double>::infinity()
+                         << "-inf" << -std::numeric_limits<double>::infinity()));
+
+    // Random bit patterns cover subnormals, huge and tiny exponents
+    std::mt19937_64 random(42);
+    for (int i = 0; i < 10000; ++i) {
+        mongo::BSONObjBuilder builder;
+        for (int j = 0; j < 10; ++j) {
+            unsigned long long bits = random();
+            double d;
+            memcpy(&d, &bits, sizeof(d));
+            // JParse rejects subnormals (strtod reports ERANGE), NaN payloads are not preserved
+            if (std::isnormal(d))
+                builder.append(std::to_string(j), d);
+            builder.append("i" + std::to_string(j), static_cast<int>(bits));
+            builder.append("l" + std::to_string(j), static_cast<long long>(bits >> (bits % 64)));
+        }
+        roundTripAssert(builder.obj());
+    }
+}
+
+/**
+ * @brief Line breaks counted by BsonUtils::jsonLineBreaks are the same as in pretty JSON
+ */
+void lineBreaksAssert(const mongo::BSONObj &obj) {
+    std::string json = Robomongo::BsonUtils::jsonString(obj, Robomongo::BsonUtils::TenGenJson, 1, Robomongo::DefaultEncoding, Robomongo::Utc);
+    assert(Robomongo::BsonUtils::jsonLineBreaks(obj) == std::count(json.begin(), json.end(), '\n'));
+}
+
+void testJsonLineBreaks() {
+    lineBreaksAssert(mongo::BSONObj());
+    lineBreaksAssert(BSON("a" << 1 << "empty" << mongo::BSONObj() << "emptyArray" << mongo::BSONArray()));
+    lineBreaksAssert(BSON("nested" << BSON("a" << BSON("b" << BSON_ARRAY(1 << BSON("c" << 2) << BSON_ARRAY(3 << 4))))));
+    lineBreaksAssert(BSON("text" << "multi\nline" << "oid" << mongo::OID::gen()));
+
+    mongo::BSONObjBuilder builder;
+    builder.appendCode("code", "function() {\n    return 1;\n}");
+    builder.appendCodeWScope("scope", "function() {\n    return x;\n}", BSON("x" << 1));
+    builder.appendDBRef("ref", "db.collection", mongo::OID::gen());
+    lineBreaksAssert(builder.obj());
+}
+
+/**
+ * @brief Sink that collects chunks passed by BsonUtils::writeJson
+ */
+struct ChunksSink : public Robomongo::BsonUtils::JsonSink {
+    std::string text;
+    int chunks = 0;
+
+    virtual void append(const char *data, size_t size) {
+        text.append(data, size);
+        ++chunks;
+    }
+};
+
+void testJsonSink() {
+    mongo::BSONArrayBuilder items;
+    for (int i = 0; i < 20000; ++i)
+        items.append(BSON("i" << i << "name" << "item" << "date" << mongo::Date_t::fromMillisSinceEpoch(i)));
+    mongo::BSONObj obj = BSON("_id" << 1 << "items" << items.arr());
+
+    // Large document is passed in several chunks, text is the same as in string
+    const Robomongo::BsonUtils::JsonFormat formats[] = { Robomongo::BsonUtils::TenGenJson, Robomongo::BsonUtils::StrictJson, Robomongo::BsonUtils::RelaxedJson };
+    for (const Robomongo::BsonUtils::JsonFormat format : formats) {
+        ChunksSink sink;
+        Robomongo::BsonUtils::writeJson(sink, obj, format, 1, Robomongo::DefaultEncoding, Robomongo::Utc);
+        assert(sink.chunks > 1);
+        assert(sink.text == Robomongo::BsonUtils::jsonString(obj, format, 1, Robomongo::DefaultEncoding, Robomongo::Utc));
+    }
+
+    ChunksSink small;
+    Robomongo::BsonUtils::writeJson(small, BSON("a" << 1), Robomongo::BsonUtils::TenGenJson, 0, Robomongo::DefaultEncoding, Robomongo::Utc);
+    assert(small.chunks == 1);
+}
+
+/**
+ * @brief Types without JSON equivalent are written as Extended JSON v2 defines them
+ */
+void testRelaxedJson() {
+    mongo::BSONObjBuilder builder;
+    builder.appendRegex("r", "a\"b", "mi");
+    builder.appendCodeWScope("c", "f()", BSON("x" << 1));
+    builder.appendBinData("b", 3, mongo::BinDataGeneral, "abc");
+    builder.appendSymbol("s", "sym");
+    builder.append("n", 5LL);
+    const std::string json = Robomongo::BsonUtils::jsonString(builder.obj(), Robomongo::BsonUtils::RelaxedJson, 0,
+                                                              Robomongo::DefaultEncoding, Robomongo::Utc);
+    assert(json == "{ \"r\" : { \"$regularExpression\" : { \"pattern\" : \"a\\\"b\", \"options\" : \"im\" } }, "
+                   "\"c\" : { \"$code\" : \"f()\", \"$scope\" : { \"x\" : 1 } }, "
+                   "\"b\" : { \"$binary\" : { \"base64\" : \"YWJj\", \"subType\" : \"00\" } }, "
+                   "\"s\" : { \"$symbol\" : \"sym\" }, \"n\" : 5 }");
+}
+
+/**
+ * @brief DateUtils::formatIsoDate writes the same text as miutil::isotimeString in UTC,
+ * local time with its offset is the same moment
+ */
+void dateAssert(long long ms) {
+    boost::posix_time::ptime epoch(boost::gregorian::date(1970, 1, 1));
+    std::string date;
+    Robomongo::DateUtils::appendIsoDate(date, ms, true, false);
+    assert(date == miutil::isotimeString(epoch + boost::posix_time::millisec(ms), true, false));
+
+    std::string local;
+    Robomongo::DateUtils::appendIsoDate(local, ms, true, true);
+    mongo::BSONObj parsed = mongo::Robomongo::fromjson("{ \"d\" : ISODate(\"" + local + "\") }");
+    assert(parsed["d"].Date().toMillisSinceEpoch() == ms);
+}
+
+void testIsoDates() {
+    dateAssert(0);
+    dateAssert(-1);
+    dateAssert(951782400000LL);       // 2000-02-29
+    dateAssert(miutil::minDate + 1);
+    dateAssert(miutil::maxDate - 1);
+
+    std::mt19937_64 random(42);
+    for (int i = 0; i < 10000; ++i)
+        dateAssert(static_cast<long long>(random() % (2 * miutil::maxDate)) - miutil::maxDate);
+}
+
+void uuidAssert(const std::string &expected, mongo::BinDataType type, Robomongo::UUIDEncoding encoding) {
+    const char bytes[] = "\x00\x01\x02\x03\x04\x05\x06\x07\x08\x09\x0a\x0b\x0c\x0d\x0e\x0f";
+    mongo::BSONObjBuilder builder;
+    builder.appendBinData("uuid", 16, type, bytes);
+    mongo::BSONObj obj = builder.obj();
+    assert(Robomongo::HexUtils::formatUuid(obj["uuid"], encoding) == expected);
+
+    // Text without function name and quotes is parsed back to same bytes
+    const std::string uuid = expected.substr(expected.find('"') + 1, Robomongo::HexUtils::uuidLength);
+    assert(Robomongo::HexUtils::uuidToHex(uuid, type == mongo::newUUID ? Robomongo::DefaultEncoding : encoding)
+           == "000102030405060708090a0b0c0d0e0f");
+}
+
+void testUuid() {
+    uuidAssert("UUID(\"00010203-0405-0607-0809-0a0b0c0d0e0f\")", mongo::newUUID, Robomongo::JavaLegacy);
+    uuidAssert("LUUID(\"00010203-0405-0607-0809-0a0b0c0d0e0f\")", mongo::bdtUUID, Robomongo::DefaultEncoding);
+    uuidAssert("JUUID(\"07060504-0302-0100-0f0e-0d0c0b0a0908\")", mongo::bdtUUID, Robomongo::JavaLegacy);
+    uuidAssert("NUUID(\"03020100-0504-0706-0809-0a0b0c0d0e0f\")", mongo::bdtUUID, Robomongo::CSharpLegacy);
+    uuidAssert("PYUUID(\"00010203-0405-0607-0809-0a0b0c0d0e0f\")", mongo::bdtUUID, Robomongo::PythonLegacy);
+
+    // Blocks of 16 bytes and tails of every length
+    std::mt19937 random(42);
+    for (int len = 0; len < 100; ++len) {
+        std::string bytes(len, '\0');
+        for (int i = 0; i < len; ++i)
+            bytes[i] = static_cast<char>(random());
+        assert(Robomongo::HexUtils::toStdHexLower(bytes.data(), len) == mongo::toHexLower(bytes.data(), len));
+    }
+}
+
+/**
+ * @brief Styles of characters of 'text' written by JsonLexer, one letter per style:
+ * Default, Comment, Number, Keyword, String, key (Y), Operator
+ */
+std::string lexerStyles(const std::string &text, int &state) {
+    std::vector<unsigned char> styles(text.size());
+    state = Robomongo::JsonLexer::scan(text.data(), text.size(), state, styles.data());
+
+    std::string result;
+    for (size_t i = 0; i < styles.size(); ++i)
+        result += "DCNKSYO"[styles[i]];
+    return result;
+}
+
+void testJsonLexer() {
+    int state = Robomongo::JsonLexer::StateDefault;
+    assert(lexerStyles("/* 1 */", state) == "CCCCCCC");
+    assert(lexerStyles("    \"_id\" : ObjectId(\"5f1d\"),", state) == "DDDDYYYYYDODKKKKKKKKOSSSSSSOO");
+    assert(lexerStyles("\"a\\\"b\" : -1.5e+21, \"n\" : NaN", state) == "YYYYYYDODNNNNNNNNODYYYDODNNN");
+    assert(lexerStyles("[true, null, -Infinity, x]", state) == "OKKKKODKKKKODNNNNNNNNNODDO");
+
+    // Comment in code goes on next line
+    assert(lexerStyles("function() { /* a\n", state) == "KKKKKKKKOODODCCCCC");
+    assert(state == Robomongo::JsonLexer::StateComment);
+    assert(lexerStyles("b */ }", state) == "CCCCDO");
+    assert(state == Robomongo::JsonLexer::StateOperator);
+}
+
+/**
+ * @brief Text of file written by ResultWriter
+ */
+std::string savedResult(Robomongo::ResultWriter::Format format, const std::vector<mongo::BSONObj> &documents) {
+    const QString path = QDir::temp().filePath("robomongo_test_result.json");
+    Robomongo::ResultWriter writer(path, format, Robomongo::DefaultEncoding, Robomongo::Utc);
+    assert(writer.open());
+    for (size_t i = 0; i < documents.size(); ++i)
+        assert(writer.write(documents[i]));
+    assert(writer.close());
+    assert(writer.written() == static_cast<long long>(documents.size()));
+
+    QFile file(path);
+    assert(file.open(QIODevice::ReadOnly));
+    const QByteArray text = file.readAll();
+    file.close();
+    file.remove();
+    return std::string(text.constData(), text.size());
+}
+
+void savedArrayAssert(Robomongo::ResultWriter::Format format, const std::vector<mongo::BSONObj> &documents) {
+    // Array is parsed back as value of field
+    mongo::BSONObj parsed = mongo::Robomongo::fromjson("{ \"r\" : " + savedResult(format, documents) + " }");
+    std::vector<mongo::BSONElement> elements = parsed.getField("r").Array();
+    assert(elements.size() == documents.size());
+    for (size_t i = 0; i < documents.size(); ++i)
+        assert(elements[i].Obj().woCompare(documents[i]) == 0);
+}
+
+void testResultWriter() {
+    typedef Robomongo::ResultWriter Writer;
+
+    // Enough documents to pass many chunks to file
+    std::vector<mongo::BSONObj> documents;
+    for (int i = 0; i < 50000; ++i) {
+        mongo::BSONObjBuilder builder;
+        builder.append("_id", i);
+        builder.append("name", std::string(40, static_cast<char>('a' + i % 26)));
+        builder.appendDate("date", mongo::Date_t::fromMillisSinceEpoch(1000LL * i));
+        builder.append("size", 1000LL * i);
+        documents.push_back(builder.obj());
+    }
+
+    savedArrayAssert(Writer::Json, documents);
+    savedArrayAssert(Writer::RelaxedExtendedJson, documents);
+
+    // Relaxed extended JSON has plain numbers and ISO dates
+    const std::string relaxed = savedResult(Writer::RelaxedExtendedJson, std::vector<mongo::BSONObj>(1, documents[1]));
+    assert(relaxed.find("\"size\" : 1000") != std::string::npos);
+    assert(relaxed.find("\"date\" : { \"$date\" : \"1970-01-01T00:00:01.000Z\" }") != std::string::npos);
+    assert(relaxed.find("NumberLong") == std::string::npos);
+
+    std::istringstream lines(savedResult(Writer::NdJson, documents));
+    std::string line;
+    size_t count = 0;
+    while (std::getline(lines, line))
+        assert(mongo::Robomongo::fromjson(line).woCompare(documents[count++]) == 0);
+    assert(count == documents.size());
+
+    // NDJSON record is one line of JSON, without shell types
+    const std::string record = savedResult(Writer::NdJson, std::vector<mongo::BSONObj>(1, documents[1]));
+    assert(record.find('\n') == record.size() - 1);
+    assert(record.find("\"size\" : { \"$numberLong\" : \"1000\" } }") != std::string::npos);
+
+    // Empty result
+    assert(savedResult(Writer::Json, std::vector<mongo::BSONObj>()) == "[\n]\n");
+    assert(savedResult(Writer::NdJson, std::vector<mongo::BSONObj>()).empty());
+
+    // Cancelled file is removed
+    const QString path = QDir::temp().filePath("robomongo_test_cancelled.json");
+    Writer writer(path, Writer::Json, Robomongo::DefaultEncoding, Robomongo::Utc);
+    assert(writer.open());
+    assert(writer.write(documents[0]));
+    writer.cancel();
+    assert(!writer.write(documents[1]));
+    assert(!writer.close());
+    assert(!QFile::exists(path));
+}
+
 int main(int argc, char *argv[], char** envp)
 {
     testHostAndPort();
     testPrecision();
+    testParallelSort();
+    testEscape();
+    testNumberRoundTrip();
+    testJsonLineBreaks();
+    testJsonSink();
+    testRelaxedJson();
+    testIsoDates();
+    testUuid();
+    testJsonLexer();
+    testResultWriter();
     return 0;
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <QObject>
+#include <QPointer>
 #include <QString>
 #include <QEvent>
 #include <QMetaType>
@@ -44,9 +45,10 @@ namespace Robomongo
         virtual const char *typeString() = 0;
 
         /**
-         * @brief Sender that emits this event.
+         * @brief Sender that emits this event. Null, if sender was destroyed
+         * meanwhile (e.g. widget closed before its request was handled).
          */
-        QObject *sender() const { return _sender; }
+        QObject *sender() const { return _sender.data(); }
 
         /**
          * @brief Tests whether this event is "error-event".
@@ -60,9 +62,10 @@ namespace Robomongo
 
     private:
         /**
-         * @brief Sender that emits this event.
+         * @brief Sender that emits this event. Guarded, because replies are sent
+         * to it from other threads, possibly after it was destroyed.
          */
-        QObject *_sender;
+        const QPointer<QObject> _sender;
 
         /**
          * @brief Possible error.
@@ -84,8 +84,11 @@ namespace Robomongo
     {
         QMutexLocker lock(&_lock);
 
-        if (!receiver)
+        // Receiver (usually sender of request) was destroyed, reply is dropped
+        if (!receiver) {
+            delete event;
             return;
+        }
 
         QThread *thread = receiver->thread();
         EventBusDispatcher *dis = dispatcher(thread);
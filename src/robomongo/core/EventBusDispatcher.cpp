@@ -20,9 +20,11 @@ namespace Robomongo
         Event *event = wrapper->event();
 
         const char *typeName = event->typeString();
-        const QList<QObject*> &recivers = wrapper->receivers();
-        for (QList<QObject*>::const_iterator it = recivers.begin(); it != recivers.end(); ++it) {
-            QMetaObject::invokeMethod(*it, "handle", QGenericArgument(typeName, &event));
+        const QList<QPointer<QObject> > &recivers = wrapper->receivers();
+        for (QList<QPointer<QObject> >::const_iterator it = recivers.begin(); it != recivers.end(); ++it) {
+            // Late replies to destroyed receivers are dropped
+            if (*it)
+                QMetaObject::invokeMethod(*it, "handle", QGenericArgument(typeName, &event));
         }
 
         return true;
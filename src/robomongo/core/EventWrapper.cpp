@@ -2,17 +2,21 @@
 namespace Robomongo
 {
     EventWrapper::EventWrapper(Event *event, QList<QObject *> receivers) 
-        : QEvent(event->type()), _event(event), _receivers(receivers) {}
+        : QEvent(event->type()), _event(event)
+    {
+        for (QList<QObject *>::const_iterator it = receivers.begin(); it != receivers.end(); ++it)
+            _receivers.append(*it);
+    }
 
     EventWrapper::EventWrapper(Event *event, QObject * receiver)
-        : QEvent(event->type()), _event(event), _receivers(QList<QObject *>() << receiver ) {}
+        : QEvent(event->type()), _event(event), _receivers(QList<QPointer<QObject> >() << receiver ) {}
 
     Event *EventWrapper::event() const 
     {
         return _event.get(); 
     }
 
-    const QList<QObject *> &EventWrapper::receivers() const 
+    const QList<QPointer<QObject> > &EventWrapper::receivers() const 
     {
         return _receivers;
     }
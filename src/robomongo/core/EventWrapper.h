@@ -1,5 +1,6 @@
 #pragma once
 #include <boost/scoped_ptr.hpp>
+#include <QPointer>
 #include "robomongo/core/Event.h"
 
 namespace Robomongo
@@ -10,10 +11,14 @@ namespace Robomongo
         EventWrapper(Event *event, QList<QObject *> receivers);
         EventWrapper(Event *event, QObject * receiver);
         Event *event() const;
-        const QList<QObject *> &receivers() const;
+
+        /**
+         * @brief Receivers destroyed after event was sent are null.
+         */
+        const QList<QPointer<QObject> > &receivers() const;
 
     private:
         const boost::scoped_ptr<Event> _event;
-        const QList<QObject *> _receivers;
+        QList<QPointer<QObject> > _receivers;
     };
 }
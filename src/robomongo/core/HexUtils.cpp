@@ -4,6 +4,107 @@
 #include <pcrecpp.h>
 #include <iostream>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define ROBOMONGO_SSE2
+    #include <emmintrin.h>
+#endif
+
+namespace
+{
+    using namespace Robomongo;
+
+    const char hexDigits[] = "0123456789abcdef";
+
+    /**
+     * @brief Source byte of every byte of UUID text, for each UUIDEncoding. Legacy
+     * encodings store some groups of bytes in little-endian order.
+     */
+    const unsigned char uuidOrder[4][HexUtils::uuidBytes] = {
+        { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 },    // DefaultEncoding
+        { 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8 },    // JavaLegacy
+        { 3, 2, 1, 0, 5, 4, 7, 6, 8, 9, 10, 11, 12, 13, 14, 15 },    // CSharpLegacy
+        { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 }     // PythonLegacy
+    };
+
+    /**
+     * @brief Dash is written after these bytes of UUID (bit i set for byte i)
+     */
+    const unsigned int uuidDashes = (1 << 3) | (1 << 5) | (1 << 7) | (1 << 9);
+
+    const unsigned char *orderOf(UUIDEncoding encoding)
+    {
+        return uuidOrder[encoding >= DefaultEncoding && encoding <= PythonLegacy ? encoding : DefaultEncoding];
+    }
+
+    /**
+     * @brief UUID text from hex of its bytes, one allocation
+     */
+    std::string uuidFromHex(const std::string &hex, const unsigned char *order)
+    {
+        std::string uuid(HexUtils::uuidLength, '-');
+        char *dest = &uuid[0];
+        for (int i = 0; i < HexUtils::uuidBytes; ++i) {
+            *dest++ = hex.at(2 * order[i]);
+            *dest++ = hex.at(2 * order[i] + 1);
+            if (uuidDashes & (1 << i))
+                ++dest;
+        }
+        return uuid;
+    }
+
+    /**
+     * @brief Hex of bytes of UUID, 'hex' is UUID text without dashes
+     */
+    std::string uuidHexToHex(const std::string &hex, const unsigned char *order)
+    {
+        std::string result(hex.size(), '0');
+        for (int i = 0; i < HexUtils::uuidBytes; ++i) {
+            result[2 * order[i]] = hex[2 * i];
+            result[2 * order[i] + 1] = hex[2 * i + 1];
+        }
+        return result;
+    }
+
+    char *formatHexScalar(char *dest, const unsigned char *raw, size_t len)
+    {
+        for (size_t i = 0; i < len; ++i) {
+            *dest++ = hexDigits[raw[i] >> 4];
+            *dest++ = hexDigits[raw[i] & 0xF];
+        }
+        return dest;
+    }
+
+#ifdef ROBOMONGO_SSE2
+    /**
+     * @brief Nibbles are turned into digits with compare and add: '0' + n, plus
+     * ('a' - '0' - 10) for n > 9. High and low nibbles are interleaved by unpack.
+     */
+    char *formatHexSse2(char *dest, const unsigned char *raw, size_t len)
+    {
+        const __m128i lowMask = _mm_set1_epi8(0x0F);
+        const __m128i nine = _mm_set1_epi8(9);
+        const __m128i zero = _mm_set1_epi8('0');
+        const __m128i letterOffset = _mm_set1_epi8('a' - '0' - 10);
+
+        size_t i = 0;
+        for (; i + 16 <= len; i += 16) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(raw + i));
+            __m128i high = _mm_and_si128(_mm_srli_epi16(v, 4), lowMask);
+            __m128i low = _mm_and_si128(v, lowMask);
+
+            high = _mm_add_epi8(_mm_add_epi8(high, zero), _mm_and_si128(_mm_cmpgt_epi8(high, nine), letterOffset));
+            low = _mm_add_epi8(_mm_add_epi8(low, zero), _mm_and_si128(_mm_cmpgt_epi8(low, nine), letterOffset));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dest), _mm_unpacklo_epi8(high, low));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dest + 16), _mm_unpackhi_epi8(high, low));
+            dest += 32;
+        }
+
+        return formatHexScalar(dest, raw + i, len - i);
+    }
+#endif
+}
+
 namespace Robomongo
 {
     namespace HexUtils
@@ -21,9 +122,24 @@ namespace Robomongo
 
         std::string toStdHexLower(const char *raw, int len)
         {
-            const void* in = reinterpret_cast<const void*>(raw);
-            std::string stdstr = mongo::toHexLower(in, len);
-            return stdstr;
+            std::string hex;
+            appendHexLower(hex, raw, len);
+            return hex;
+        }
+
+        void appendHexLower(std::string &out, const char *raw, size_t len)
+        {
+            const size_t start = out.size();
+            out.resize(start + 2 * len);
+            if (len == 0)
+                return;
+
+            const unsigned char *bytes = reinterpret_cast<const unsigned char *>(raw);
+#ifdef ROBOMONGO_SSE2
+            formatHexSse2(&out[start], bytes, len);
+#else
+            formatHexScalar(&out[start], bytes, len);
+#endif
         }
 
         const char *fromHex(const std::string &s, int *outBytes)
@@ -58,35 +174,22 @@ namespace Robomongo
 
         std::string hexToUuid(const std::string &hex)
         {
-            std::string uuid = hex.substr(0, 8) + '-' + hex.substr(8, 4) + '-' + hex.substr(12, 4) + '-' + hex.substr(16, 4) + '-' + hex.substr(20, 12);
-            return uuid;
+            return uuidFromHex(hex, orderOf(DefaultEncoding));
         }
 
         std::string hexToCSharpUuid(const std::string &hex)
         {
-            std::string a = hex.substr(6, 2) + hex.substr(4, 2) + hex.substr(2, 2) + hex.substr(0, 2);
-            std::string b = hex.substr(10, 2) + hex.substr(8, 2);
-            std::string c = hex.substr(14, 2) + hex.substr(12, 2);
-            std::string d = hex.substr(16, 16);
-            std::string temp = a + b + c + d;
-            std::string uuid = temp.substr(0, 8) + '-' + temp.substr(8, 4) + '-' + temp.substr(12, 4) + '-' + temp.substr(16, 4) + '-' + temp.substr(20, 12);
-            return uuid;
+            return uuidFromHex(hex, orderOf(CSharpLegacy));
         }
 
         std::string hexToJavaUuid(const std::string &hex)
         {
-            std::string msb = hex.substr(0, 16);
-            std::string lsb = hex.substr(16, 16);
-            msb = msb.substr(14, 2) + msb.substr(12, 2) + msb.substr(10, 2) + msb.substr(8, 2) + msb.substr(6, 2) + msb.substr(4, 2) + msb.substr(2, 2) + msb.substr(0, 2);
-            lsb = lsb.substr(14, 2) + lsb.substr(12, 2) + lsb.substr(10, 2) + lsb.substr(8, 2) + lsb.substr(6, 2) + lsb.substr(4, 2) + lsb.substr(2, 2) + lsb.substr(0, 2);
-            std::string temp = msb + lsb;
-            std::string uuid = temp.substr(0, 8) + '-' + temp.substr(8, 4) + '-' + temp.substr(12, 4) + '-' + temp.substr(16, 4) + '-' + temp.substr(20, 12);
-            return uuid;
+            return uuidFromHex(hex, orderOf(JavaLegacy));
         }
 
         std::string hexToPythonUuid(const std::string &hex)
         {
-            return hexToUuid(hex);
+            return uuidFromHex(hex, orderOf(PythonLegacy));
         }
 
         std::string uuidToHex(const std::string &uuid, Robomongo::UUIDEncoding encoding)
@@ -123,12 +226,7 @@ namespace Robomongo
             if (hex.size() != 32)
                 return "";
 
-            std::string a = hex.substr(6, 2) + hex.substr(4, 2) + hex.substr(2, 2) + hex.substr(0, 2);
-            std::string b = hex.substr(10, 2) + hex.substr(8, 2);
-            std::string c = hex.substr(14, 2) + hex.substr(12, 2);
-            std::string d = hex.substr(16, 16);
-            std::string result = a + b + c + d;
-            return result;
+            return uuidHexToHex(hex, orderOf(CSharpLegacy));
         }
 
         std::string javaUuidToHex(const std::string &uuid)
@@ -141,12 +239,7 @@ namespace Robomongo
             if (hex.size() != 32)
                 return "";
 
-            std::string msb = hex.substr(0, 16);
-            std::string lsb = hex.substr(16, 16);
-            msb = msb.substr(14, 2) + msb.substr(12, 2) + msb.substr(10, 2) + msb.substr(8, 2) + msb.substr(6, 2) + msb.substr(4, 2) + msb.substr(2, 2) + msb.substr(0, 2);
-            lsb = lsb.substr(14, 2) + lsb.substr(12, 2) + lsb.substr(10, 2) + lsb.substr(8, 2) + lsb.substr(6, 2) + lsb.substr(4, 2) + lsb.substr(2, 2) + lsb.substr(0, 2);
-            std::string result = msb + lsb;
-            return result;
+            return uuidHexToHex(hex, orderOf(JavaLegacy));
         }
 
         std::string pythonUuidToHex(const std::string &uuid)
@@ -155,6 +248,13 @@ namespace Robomongo
         }
 
         std::string formatUuid(const mongo::BSONElement &element, Robomongo::UUIDEncoding encoding)
+        {
+            std::string result;
+            appendUuid(result, element, encoding);
+            return result;
+        }
+
+        void appendUuid(std::string &out, const mongo::BSONElement &element, UUIDEncoding encoding)
         {
             mongo::BinDataType binType = element.binDataType();
 
@@ -163,22 +263,39 @@ namespace Robomongo
 
             int len;
             const char *data = element.binData(len);
-            std::string hex = HexUtils::toStdHexLower(data, len);
+            if (len != uuidBytes)
+                throw std::invalid_argument("UUID should be 16 bytes long");
 
             if (binType == mongo::bdtUUID) {
-                std::string uuid = HexUtils::hexToUuid(hex, encoding);
-
                 switch(encoding) {
-                case DefaultEncoding: return "LUUID(\"" + uuid + "\")";
-                case JavaLegacy:      return "JUUID(\"" + uuid + "\")";
-                case CSharpLegacy:    return "NUUID(\"" + uuid + "\")";
-                case PythonLegacy:    return "PYUUID(\"" + uuid + "\")";
-                default:              return "LUUID(\"" + uuid + "\")";
+                case DefaultEncoding: out.append("LUUID(\""); break;
+                case JavaLegacy:      out.append("JUUID(\""); break;
+                case CSharpLegacy:    out.append("NUUID(\""); break;
+                case PythonLegacy:    out.append("PYUUID(\""); break;
+                default:              out.append("LUUID(\""); break;
                 }
             } else {
-                std::string uuid = HexUtils::hexToUuid(hex, DefaultEncoding);
-                return "UUID(\"" + uuid + "\")";
+                out.append("UUID(\"");
+                encoding = DefaultEncoding;
+            }
+
+            char uuid[uuidLength];
+            out.append(uuid, formatUuid(uuid, data, encoding));
+            out.append("\")");
+        }
+
+        char *formatUuid(char *dest, const char *raw, UUIDEncoding encoding)
+        {
+            const unsigned char *bytes = reinterpret_cast<const unsigned char *>(raw);
+            const unsigned char *order = orderOf(encoding);
+            for (int i = 0; i < uuidBytes; ++i) {
+                const unsigned char byte = bytes[order[i]];
+                *dest++ = hexDigits[byte >> 4];
+                *dest++ = hexDigits[byte & 0xF];
+                if (uuidDashes & (1 << i))
+                    *dest++ = '-';
             }
+            return dest;
         }
     }
 }
@@ -22,8 +22,16 @@ namespace Robomongo
      */
     namespace HexUtils
     {
+        enum { uuidLength = 36 };     // characters of UUID text, without quotes
+        enum { uuidBytes = 16 };
+
         bool isHexString(const std::string &hex);
         std::string toStdHexLower(const char *raw, int len);
+
+        /**
+         * @brief Appends lower-case hex of 'raw' to 'out', 16 bytes at a time with SSE2
+         */
+        void appendHexLower(std::string &out, const char *raw, size_t len);
         /**
          * @param str: data in hex format.
          * @param outBytes: out param - number of bytes in array.
@@ -44,5 +52,17 @@ namespace Robomongo
         std::string javaUuidToHex(const std::string &uuid);
         std::string pythonUuidToHex(const std::string &uuid);
         std::string formatUuid(const mongo::BSONElement &element, UUIDEncoding encoding);
+
+        /**
+         * @brief Same as formatUuid(), written straight into 'out' from raw bytes of UUID
+         */
+        void appendUuid(std::string &out, const mongo::BSONElement &element, UUIDEncoding encoding);
+
+        /**
+         * @brief Writes 36 characters of UUID (with dashes) from 16 raw bytes,
+         * in byte order of 'encoding'
+         * @return end of written text, not null-terminated
+         */
+        char *formatUuid(char *dest, const char *raw, UUIDEncoding encoding);
     }
 }
@@ -39,7 +39,9 @@ namespace Robomongo
     void MongoDatabase::loadCollections()
     {
         _bus->publish(new MongoDatabaseCollectionsLoadingEvent(this));
-        _bus->send(_server->worker(), new LoadCollectionNamesRequest(this, _name));
+        // Repeated refreshes of the same database supersede each other
+        SupersessionTicket ticket = _server->worker()->supersede("collections/" + _name);
+        _bus->send(_server->worker(), new LoadCollectionNamesRequest(this, _name, ticket));
     }
 
     void MongoDatabase::loadUsers()
@@ -28,7 +28,10 @@ namespace Robomongo
         return !_serverAddress.empty() && _ns.isValid();
     }
 
-    MongoQueryInfo::MongoQueryInfo() {}
+    MongoQueryInfo::MongoQueryInfo() :
+        _projectedColumns(false),
+        _truncateValues(false)
+        {}
 
     MongoQueryInfo::MongoQueryInfo(const CollectionInfo &info,
               mongo::BSONObj query, mongo::BSONObj fields, int limit, int skip, int batchSize,
@@ -40,6 +43,8 @@ namespace Robomongo
         _skip(skip),
         _batchSize(batchSize),
         _options(options),
-        _special(special)
+        _special(special),
+        _projectedColumns(false),
+        _truncateValues(false)
         {}
 }
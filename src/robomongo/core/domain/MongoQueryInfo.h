@@ -37,6 +37,9 @@ namespace Robomongo
         int _options;
         bool _special; // flag, indicating that `query` contains special fields on
                       // first level, and query data in `query` field.
-        
+        bool _projectedColumns; // `fields` excludes hidden columns of table view,
+                                // documents are partial and should be fetched by _id when needed.
+        bool _truncateValues;   // long strings and arrays are truncated on server, see MongoClient::query()
+
     };
 }
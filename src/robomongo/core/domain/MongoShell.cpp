@@ -1,5 +1,7 @@
 #include "robomongo/core/domain/MongoShell.h"
 
+#include <sstream>
+
 #include "mongo/scripting/engine.h"
 
 #include "robomongo/core/domain/MongoServer.h"
@@ -16,7 +18,8 @@ namespace Robomongo
     MongoShell::MongoShell(MongoServer *server, const ScriptInfo &scriptInfo) :
         QObject(),
         _scriptInfo(scriptInfo),
-        _server(server)
+        _server(server),
+        _autocompleteGeneration(std::make_shared<QAtomicInt>(0))
     {
     }
 
@@ -28,6 +31,13 @@ namespace Robomongo
         LOG_MSG(_scriptInfo.script(), mongo::logger::LogSeverity::Info());
     }
 
+    std::string MongoShell::supersessionKey(const char *request, int resultIndex) const
+    {
+        std::stringstream key;
+        key << request << "/" << this << "/" << resultIndex;
+        return key.str();
+    }
+
     std::string MongoShell::query() const 
     {
         return QtUtils::toStdString(_scriptInfo.script()); 
@@ -49,7 +59,15 @@ namespace Robomongo
 
     void MongoShell::query(int resultIndex, const MongoQueryInfo &info)
     {
-        AppRegistry::instance().bus()->send(_server->worker(), new ExecuteQueryRequest(this, resultIndex, info));
+        // Only the latest page of this result is needed
+        SupersessionTicket ticket = _server->worker()->supersede(supersessionKey("query", resultIndex));
+        AppRegistry::instance().bus()->send(_server->worker(), new ExecuteQueryRequest(this, resultIndex, info, ticket));
+    }
+
+    void MongoShell::explain(int resultIndex, const MongoQueryInfo &info)
+    {
+        SupersessionTicket ticket = _server->worker()->supersede(supersessionKey("explain", resultIndex));
+        AppRegistry::instance().bus()->send(_server->worker(), new ExplainQueryRequest(this, resultIndex, info, ticket));
     }
 
     void MongoShell::autocomplete(const std::string &prefix)
@@ -57,7 +75,14 @@ namespace Robomongo
         AutocompletionMode autocompletionMode = AppRegistry::instance().settingsManager()->autocompletionMode();
         if (autocompletionMode == AutocompleteNone)
             return;
-        AppRegistry::instance().bus()->send(_server->worker(), new AutocompleteRequest(this, prefix, autocompletionMode));
+        int generation = _autocompleteGeneration->fetchAndAddOrdered(1) + 1;
+        AppRegistry::instance().bus()->send(_server->worker(),
+            new AutocompleteRequest(this, prefix, autocompletionMode, generation, _autocompleteGeneration));
+    }
+
+    void MongoShell::cancelAutocomplete()
+    {
+        _autocompleteGeneration->fetchAndAddOrdered(1);
     }
 
     void MongoShell::stop()
@@ -91,6 +116,16 @@ namespace Robomongo
         AppRegistry::instance().bus()->publish(new DocumentListLoadedEvent(this, event->resultIndex, event->queryInfo, query(), event->documents));
     }
 
+    void MongoShell::handle(ExplainQueryResponse *event)
+    {
+        if (event->isError()) {
+            AppRegistry::instance().bus()->publish(new QueryExplainedEvent(this, event->resultIndex, event->error()));
+            return;
+        }
+
+        AppRegistry::instance().bus()->publish(new QueryExplainedEvent(this, event->resultIndex, event->explain));
+    }
+
     void MongoShell::handle(ExecuteScriptResponse *event)
     {
         if (event->isError()) {
@@ -115,11 +150,15 @@ namespace Robomongo
 
     void MongoShell::handle(AutocompleteResponse *event)
     {
+        // Response to superseded request
+        if (event->generation != _autocompleteGeneration->load())
+            return;
+
         if (event->isError()) {
-            AppRegistry::instance().bus()->publish(new AutocompleteResponse(this, event->error()));
+            AppRegistry::instance().bus()->publish(new AutocompleteResponse(this, event->error(), event->generation));
             return;
         }
 
-        AppRegistry::instance().bus()->publish(new AutocompleteResponse(this, event->list, event->prefix));
+        AppRegistry::instance().bus()->publish(new AutocompleteResponse(this, event->list, event->prefix, event->generation));
     }
 }
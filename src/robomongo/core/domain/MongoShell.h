@@ -14,7 +14,13 @@ namespace Robomongo
 
         void open(const std::string &script, const std::string &dbName = std::string());
         void query(int resultIndex, const MongoQueryInfo &info);
+        void explain(int resultIndex, const MongoQueryInfo &info);
         void autocomplete(const std::string &prefix);
+
+        /**
+         * @brief Discards all pending autocompletion requests and their responses
+         */
+        void cancelAutocomplete();
         void stop();
         MongoServer *server() const { return _server; }
         std::string query() const;
@@ -31,12 +37,18 @@ namespace Robomongo
 
     protected Q_SLOTS:
         void handle(ExecuteQueryResponse *event);
+        void handle(ExplainQueryResponse *event);
         void handle(ExecuteScriptResponse *event);
         void handle(AutocompleteResponse *event);
 
     private:        
+        std::string supersessionKey(const char *request, int resultIndex) const;
+
         ScriptInfo _scriptInfo;
         MongoServer *_server;
+
+        // Generation of the latest autocompletion request, shared with worker thread
+        std::shared_ptr<QAtomicInt> _autocompleteGeneration;
     };
 
 }
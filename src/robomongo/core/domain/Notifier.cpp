@@ -1,9 +1,15 @@
 #include "robomongo/core/domain/Notifier.h"
 
+#include <algorithm>
+
 #include <QAction>
 #include <QClipboard>
 #include <QApplication>
+#include <QFileDialog>
 #include <QMenu>
+#include <QMimeData>
+#include <QProgressDialog>
+#include <QPushButton>
 
 #include "robomongo/core/domain/MongoShell.h"
 #include "robomongo/core/utils/QtUtils.h"
@@ -11,11 +17,14 @@
 #include "robomongo/core/utils/BsonUtils.h"
 #include "robomongo/core/settings/SettingsManager.h"
 #include "robomongo/core/domain/MongoServer.h"
+#include "robomongo/core/domain/MongoDocument.h"
+#include "robomongo/core/domain/ResultWriter.h"
 #include "robomongo/core/events/MongoEvents.h"
 
 #include "robomongo/shell/db/ptimeutil.h"
 
 #include "robomongo/gui/widgets/workarea/BsonTreeItem.h"
+#include "robomongo/gui/widgets/workarea/JsonCopyThread.h"
 #include "robomongo/gui/dialogs/DocumentTextEditor.h"
 #include "robomongo/gui/utils/DialogUtils.h"
 #include "robomongo/gui/GuiRegistry.h"
@@ -48,7 +57,8 @@ namespace Robomongo
 
         bool isArrayChild(BsonTreeItem const *item)
         {
-            return BsonUtils::isArray(dynamic_cast<BsonTreeItem*>(item->parent())->type());
+            BsonTreeItem const *parent = item->parent();
+            return parent && BsonUtils::isArray(parent->type());
         }
 
         bool isDocumentRoot(BsonTreeItem const *item)
@@ -99,7 +109,9 @@ namespace Robomongo
         BaseClass(parent),
         _observer(observer),
         _shell(shell),
-        _queryInfo(queryInfo)
+        _queryInfo(queryInfo),
+        _copyThread(NULL),
+        _copyProgress(NULL)
     {
         QWidget *wid = dynamic_cast<QWidget*>(_observer);
         AppRegistry::instance().bus()->subscribe(this, InsertDocumentResponse::Type, _shell->server());
@@ -134,6 +146,16 @@ namespace Robomongo
 
         _copyJsonAction = new QAction("Copy JSON", wid);
         VERIFY(connect(_copyJsonAction, SIGNAL(triggered()), SLOT(onCopyJson())));        
+
+        _copyDocumentsJsonAction = new QAction("Copy JSON", wid);
+        VERIFY(connect(_copyDocumentsJsonAction, SIGNAL(triggered()), SLOT(onCopyDocumentsJson())));
+    }
+
+    Notifier::~Notifier()
+    {
+        // Thread deletes itself when finished
+        if (_copyThread)
+            _copyThread->stop();
     }
 
     void Notifier::initMenu(QMenu *const menu, BsonTreeItem *const item)
@@ -177,6 +199,8 @@ namespace Robomongo
     {
         bool isEditable = _queryInfo._info.isValid();
 
+        menu->addAction(_copyDocumentsJsonAction);
+        if (isEditable) menu->addSeparator();
         if (isEditable) menu->addAction(_insertDocumentAction);
         if (isEditable) menu->addAction(_deleteDocumentsAction);
     }
@@ -293,7 +317,7 @@ namespace Robomongo
                 namesList.push_front(QString::fromStdString(documentItemHelper->fieldName()));
             }
 
-            documentItemHelper = dynamic_cast<BsonTreeItem*>(documentItemHelper->parent());
+            documentItemHelper = documentItemHelper->parent();
         }
 
         QClipboard *clipboard = QApplication::clipboard();
@@ -360,7 +384,16 @@ namespace Robomongo
 
         mongo::BSONObj obj = documentItem->superRoot();
 
-        std::string str = BsonUtils::jsonString(obj, mongo::TenGen, 1,
+        // Saving partial document would remove hidden fields and truncate values
+        if (isPartial())
+            return fetchFullDocument(obj, FetchForEdit);
+
+        editDocument(obj);
+    }
+
+    void Notifier::editDocument(const mongo::BSONObj &obj)
+    {
+        std::string str = BsonUtils::jsonString(obj, BsonUtils::TenGenJson, 1,
             AppRegistry::instance().settingsManager()->uuidEncoding(),
             AppRegistry::instance().settingsManager()->timeZone());
 
@@ -389,7 +422,15 @@ namespace Robomongo
 
         mongo::BSONObj obj = documentItem->superRoot();
 
-        std::string str = BsonUtils::jsonString(obj, mongo::TenGen, 1,
+        if (isPartial())
+            return fetchFullDocument(obj, FetchForView);
+
+        viewDocument(obj);
+    }
+
+    void Notifier::viewDocument(const mongo::BSONObj &obj)
+    {
+        std::string str = BsonUtils::jsonString(obj, BsonUtils::TenGenJson, 1,
             AppRegistry::instance().settingsManager()->uuidEncoding(),
             AppRegistry::instance().settingsManager()->timeZone());
 
@@ -402,6 +443,66 @@ namespace Robomongo
         editor->show();
     }
 
+    void Notifier::fetchFullDocument(const mongo::BSONObj &obj, FetchPurpose purpose, const std::string &field)
+    {
+        mongo::BSONElement id = obj.getField("_id");
+        if (id.eoo()) {
+            QMessageBox::warning(dynamic_cast<QWidget*>(_observer), "Cannot load document",
+                "Selected document doesn't have _id field, full document cannot be loaded.");
+            return;
+        }
+
+        mongo::BSONObjBuilder builder;
+        builder.append(id);
+
+        MongoQueryInfo info(_queryInfo);
+        info._query = builder.obj();
+        info._special = false;
+        info._skip = 0;
+        info._limit = 1;
+        info._batchSize = 1;
+        info._truncateValues = false;
+
+        // Columns are projected only when query itself has no projection
+        if (info._projectedColumns)
+            info._fields = mongo::BSONObj();
+        info._projectedColumns = false;
+
+        if (!field.empty())
+            info._fields = BSON(field << 1);
+
+        _fetchedField = field;
+
+        // Purpose is passed as result index, response is sent back to this notifier
+        AppRegistry::instance().bus()->send(_shell->server()->worker(),
+            new ExecuteQueryRequest(this, purpose, info));
+    }
+
+    void Notifier::handle(ExecuteQueryResponse *event)
+    {
+        if (event->isError()) {
+            QMessageBox::warning(NULL, "Database Error", QString::fromStdString(event->error().errorMessage()));
+            return;
+        }
+
+        if (event->documents.empty()) {
+            QMessageBox::warning(dynamic_cast<QWidget*>(_observer), "Cannot load document",
+                "Document was not found, maybe it was removed.");
+            return;
+        }
+
+        mongo::BSONObj obj = event->documents.front()->bsonObj();
+        if (event->resultIndex == FetchForCopy) {
+            copyJson(obj.getField(_fetchedField));
+        }
+        else if (event->resultIndex == FetchForEdit) {
+            editDocument(obj);
+        }
+        else {
+            viewDocument(obj);
+        }
+    }
+
     void Notifier::onInsertDocument()
     {
         if (!_queryInfo._info.isValid())
@@ -489,17 +590,145 @@ namespace Robomongo
          if (!detail::isDocumentType(documentItem))
              return;
 
+         // Only the beginning of value was loaded
+         if (documentItem->isTruncated())
+             return fetchFullDocument(documentItem->superRoot(), FetchForCopy, documentItem->fieldName());
+
+         copyDocuments(std::vector<mongo::BSONObj>(1, documentItem->obj().getOwned()), BsonUtils::isArray(documentItem->type()));
+     }
+
+     void Notifier::onCopyDocumentsJson()
+     {
+         // One item per document, documents are copied in order of result
+         std::vector<const BsonTreeItem *> items;
+         QModelIndexList indexes = _observer->selectedIndexes();
+         for (int i = 0; i < indexes.count(); ++i) {
+             BsonTreeItem *item = QtUtils::item<BsonTreeItem*>(indexes[i]);
+             if (item)
+                 items.push_back(item->superParent());
+         }
+
+         std::sort(items.begin(), items.end(), [](const BsonTreeItem *left, const BsonTreeItem *right) {
+             return left->row() < right->row();
+         });
+         items.erase(std::unique(items.begin(), items.end()), items.end());
+
+         std::vector<mongo::BSONObj> documents;
+         documents.reserve(items.size());
+         for (size_t i = 0; i < items.size(); ++i)
+             documents.push_back(items[i]->superRoot().getOwned());
+
+         if (!documents.empty())
+             copyDocuments(documents, false);
+     }
+
+     void Notifier::copyJson(const mongo::BSONElement &element)
+     {
+         if (element.eoo())
+             return;
+
+         if (BsonUtils::isDocument(element))
+             return copyDocuments(std::vector<mongo::BSONObj>(1, element.Obj().getOwned()), BsonUtils::isArray(element));
+
+         std::string str;
+         BsonUtils::buildJsonString(element, str,
+             AppRegistry::instance().settingsManager()->uuidEncoding(),
+             AppRegistry::instance().settingsManager()->timeZone());
+
          QClipboard *clipboard = QApplication::clipboard();
-         mongo::BSONObj obj = documentItem->root();
-         if (documentItem != documentItem->superParent()) {
-             obj = obj[documentItem->fieldName()].Obj();
+         clipboard->setText(QtUtils::toQString(str));
+     }
+
+     void Notifier::copyDocuments(const std::vector<mongo::BSONObj> &documents, bool isArray)
+     {
+         QWidget *parent = dynamic_cast<QWidget*>(_observer);
+         SettingsManager *settings = AppRegistry::instance().settingsManager();
+
+         // Text of huge selection can be saved to file instead, with constant memory
+         ResultWriterPtr writer;
+         const size_t size = JsonCopyThread::estimatedSize(documents);
+         if (size * copyPeakFactor > copyWarningSize) {
+             QMessageBox box(QMessageBox::Warning, "Copy JSON",
+                             QString("JSON of selected documents is about %1 MB. Copying it to clipboard takes "
+                                     "much memory, it can be saved to file instead.").arg(size / (1024 * 1024)),
+                             QMessageBox::Cancel, parent);
+             QPushButton *copy = box.addButton("Copy", QMessageBox::AcceptRole);
+             QPushButton *save = box.addButton("Save to File...", QMessageBox::AcceptRole);
+             box.setDefaultButton(save);
+             box.exec();
+
+             if (box.clickedButton() == save) {
+                 const QString path = QFileDialog::getSaveFileName(parent, "Save JSON", "documents.json", "JSON (*.json)");
+                 if (path.isEmpty())
+                     return;
+
+                 writer.reset(new ResultWriter(path, ResultWriter::Json, settings->uuidEncoding(), settings->timeZone()));
+                 if (!writer->open()) {
+                     QMessageBox::critical(parent, "Save JSON", "Cannot create file:\n" + writer->error());
+                     return;
+                 }
+             }
+             else if (box.clickedButton() != copy) {
+                 return;
+             }
+         }
+
+         // Result of previous copy is ignored, its thread deletes itself when finished
+         if (_copyThread)
+             _copyThread->stop();
+
+         _copyThread = new JsonCopyThread(documents, isArray, settings->uuidEncoding(), settings->timeZone(), writer);
+         VERIFY(connect(_copyThread, SIGNAL(progress(int)), this, SLOT(copyProgress(int))));
+         VERIFY(connect(_copyThread, SIGNAL(finished()), this, SLOT(jsonCopied())));
+         VERIFY(connect(_copyThread, SIGNAL(finished()), _copyThread, SLOT(deleteLater())));
+
+         if (!_copyProgress) {
+             _copyProgress = new QProgressDialog(parent);
+             _copyProgress->setWindowTitle("Copy JSON");
+             _copyProgress->setAutoReset(false);
+             _copyProgress->setMinimumDuration(copyProgressDelayMs);
+             VERIFY(connect(_copyProgress, SIGNAL(canceled()), this, SLOT(cancelCopy())));
+         }
+
+         // Dialog appears only when copy takes longer than 'copyProgressDelayMs'
+         _copyProgress->setLabelText(writer ? "Saving JSON to file..." : "Copying JSON...");
+         _copyProgress->setRange(0, static_cast<int>(documents.size()));
+         _copyProgress->setValue(0);
+         _copyThread->start();
+     }
+
+     void Notifier::copyProgress(int processed)
+     {
+         if (_copyProgress && sender() == _copyThread)
+             _copyProgress->setValue(processed);
+     }
+
+     void Notifier::cancelCopy()
+     {
+         if (_copyThread)
+             _copyThread->stop();
+     }
+
+     void Notifier::jsonCopied()
+     {
+         JsonCopyThread *thread = qobject_cast<JsonCopyThread *>(sender());
+         if (!thread || thread != _copyThread)
+             return;
+
+         _copyThread = NULL;
+         _copyProgress->reset();
+         if (thread->isStopped())
+             return;
+
+         if (ResultWriterPtr writer = thread->writer()) {
+             if (!writer->error().isEmpty())
+                 QMessageBox::critical(dynamic_cast<QWidget*>(_observer), "Save JSON", "Cannot save JSON to file:\n" + writer->error());
+             return;
          }
-         bool isArray = BsonUtils::isArray(documentItem->type());
-         std::string str = BsonUtils::jsonString(obj, mongo::TenGen, 1,
-                 AppRegistry::instance().settingsManager()->uuidEncoding(),
-                 AppRegistry::instance().settingsManager()->timeZone(), isArray);
 
-         const QString &json = QtUtils::toQString(str);
-         clipboard->setText(json);
+         // Clipboard gets whole text at once, UTF-8 bytes are shared with thread's result
+         QMimeData *data = new QMimeData;
+         data->setData("text/plain", thread->result());
+         QApplication::clipboard()->setMimeData(data);
      }
 }
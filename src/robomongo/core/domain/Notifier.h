@@ -7,6 +7,7 @@
 QT_BEGIN_NAMESPACE
 class QAction;
 class QMenu;
+class QProgressDialog;
 QT_END_NAMESPACE
 
 namespace Robomongo
@@ -15,6 +16,8 @@ namespace Robomongo
     class BsonTreeItem;
     class InsertDocumentResponse;
     struct RemoveDocumentResponse;
+    class ExecuteQueryResponse;
+    class JsonCopyThread;
 
     namespace detail
     {
@@ -41,7 +44,12 @@ namespace Robomongo
 
     public:
         typedef QObject BaseClass;
+        enum { copyWarningSize = 192 * 1024 * 1024 };  // bytes of memory at peak of copy, larger copy asks user first
+        enum { copyPeakFactor = 3 };                    // UTF-8 text + UTF-16 copy made by clipboard when pasted
+        enum { copyProgressDelayMs = 500 };             // progress is shown only for longer copies
+
         Notifier(INotifierObserver *const observer, MongoShell *shell, const MongoQueryInfo &queryInfo, QObject *parent = NULL);
+        ~Notifier();
         void initMenu(QMenu *const menu, BsonTreeItem *const item);
         void initMultiSelectionMenu(QMenu *const menu);
 
@@ -57,14 +65,41 @@ namespace Robomongo
         void onCopyDocument();
         void onCopyTimestamp();
         void onCopyJson();
+        void onCopyDocumentsJson();
         void handle(InsertDocumentResponse *event);
         void handle(RemoveDocumentResponse *event);
+        void handle(ExecuteQueryResponse *event);
 
     private Q_SLOTS:
         void onCopyNameDocument();
         void onCopyPathDocument();
+        void copyProgress(int processed);
+        void jsonCopied();
+        void cancelCopy();
 
     private:
+        enum FetchPurpose { FetchForView = 0, FetchForEdit = 1, FetchForCopy = 2 };
+
+        /**
+         * @brief True when documents are partial (projected columns or truncated values)
+         */
+        bool isPartial() const { return _queryInfo._projectedColumns || _queryInfo._truncateValues; }
+
+        /**
+         * @brief Loads full document with the same _id as 'obj', or only its 'field' when
+         * it is not empty. Document is shown (or field copied) when ExecuteQueryResponse arrives.
+         */
+        void fetchFullDocument(const mongo::BSONObj &obj, FetchPurpose purpose, const std::string &field = std::string());
+        void editDocument(const mongo::BSONObj &obj);
+        void viewDocument(const mongo::BSONObj &obj);
+        void copyJson(const mongo::BSONElement &element);
+
+        /**
+         * @brief Formats documents in JsonCopyThread and puts text to clipboard when it is
+         * ready. When copy would take more than 'copyWarningSize' of memory, user may save it to file.
+         */
+        void copyDocuments(const std::vector<mongo::BSONObj> &documents, bool isArray);
+
         QAction *_deleteDocumentAction;
         QAction *_deleteDocumentsAction;
         QAction *_editDocumentAction;
@@ -75,7 +110,11 @@ namespace Robomongo
         QAction *_copyValuePathAction;
         QAction *_copyTimestampAction;
         QAction *_copyJsonAction;
+        QAction *_copyDocumentsJsonAction;
+        JsonCopyThread *_copyThread;
+        QProgressDialog *_copyProgress;
         const MongoQueryInfo _queryInfo;
+        std::string _fetchedField;  // field to copy, when FetchForCopy is pending
 
         MongoShell *_shell;
         INotifierObserver *const _observer;
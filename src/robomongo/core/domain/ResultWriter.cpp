@@ -0,0 +1,81 @@
+#include "robomongo/core/domain/ResultWriter.h"
+
+#include "robomongo/core/utils/BsonUtils.h"
+
+namespace Robomongo
+{
+    ResultWriter::ResultWriter(const QString &path, Format format, UUIDEncoding uuidEncoding, SupportedTimes timeZone) :
+        _file(path),
+        _format(format),
+        _uuidEncoding(uuidEncoding),
+        _timeZone(timeZone),
+        _written(0),
+        _cancelled(false)
+    {
+    }
+
+    bool ResultWriter::open()
+    {
+        if (!_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            _error = _file.errorString();
+            return false;
+        }
+
+        if (_format != NdJson)
+            append("[", 1);
+        return true;
+    }
+
+    bool ResultWriter::write(const mongo::BSONObj &obj)
+    {
+        if (_cancelled || !_error.isEmpty())
+            return false;
+
+        switch (_format)
+        {
+        case Json:
+            append(_written ? ",\n" : "\n", _written ? 2 : 1);
+            BsonUtils::writeJson(*this, obj, BsonUtils::TenGenJson, 1, _uuidEncoding, _timeZone);
+            break;
+        case NdJson:
+            BsonUtils::writeJson(*this, obj, BsonUtils::StrictJson, 0, _uuidEncoding, _timeZone);
+            append("\n", 1);
+            break;
+        case RelaxedExtendedJson:
+            append(_written ? ",\n" : "\n", _written ? 2 : 1);
+            BsonUtils::writeJson(*this, obj, BsonUtils::RelaxedJson, 1, _uuidEncoding, _timeZone);
+            break;
+        }
+
+        ++_written;
+        return _error.isEmpty();
+    }
+
+    bool ResultWriter::close()
+    {
+        if (!_file.isOpen())
+            return false;
+
+        if (!_cancelled && _error.isEmpty() && _format != NdJson)
+            append("\n]\n", 3);
+
+        _file.close();
+        if (_cancelled || !_error.isEmpty()) {
+            _file.remove();
+            return false;
+        }
+
+        return true;
+    }
+
+    void ResultWriter::append(const char *data, size_t size)
+    {
+        // After failure the rest of document is dropped, write() reports error
+        if (!_error.isEmpty())
+            return;
+
+        const qint64 length = static_cast<qint64>(size);
+        if (_file.write(data, length) != length)
+            _error = _file.errorString();
+    }
+}
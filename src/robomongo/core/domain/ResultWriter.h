@@ -0,0 +1,73 @@
+#pragma once
+
+#include <QFile>
+#include <QString>
+#include <atomic>
+#include <memory>
+#include <mongo/bson/bsonobj.h>
+
+#include "robomongo/core/Enums.h"
+#include "robomongo/core/utils/BsonUtils.h"
+
+namespace Robomongo
+{
+    /**
+     * @brief Writes documents to file one by one, as they come. JSON is passed to file
+     * in chunks while document is formatted, so memory doesn't grow with number or size
+     * of documents and whole query can be saved. Documents are written by one thread
+     * (ResultSaveThread or MongoWorker), number of written documents and cancellation
+     * are safe to use from GUI thread.
+     */
+    class ResultWriter : private BsonUtils::JsonSink
+    {
+    public:
+        enum Format
+        {
+            Json = 0,               // array of documents in shell syntax, as in text mode
+            NdJson,                 // one document per line, extended JSON
+            RelaxedExtendedJson     // array of documents in relaxed extended JSON, plain numbers and ISO dates
+        };
+
+        ResultWriter(const QString &path, Format format, UUIDEncoding uuidEncoding, SupportedTimes timeZone);
+
+        /**
+         * @brief Creates file. On failure returns false and error() describes the reason.
+         */
+        bool open();
+
+        /**
+         * @brief Appends document to file
+         * @return false when writing is cancelled or failed, documents should not be passed anymore
+         */
+        bool write(const mongo::BSONObj &obj);
+
+        /**
+         * @brief Finishes and closes file. Incomplete file (cancelled or failed) is removed.
+         * @return true when file is saved
+         */
+        bool close();
+
+        void cancel() { _cancelled = true; }
+        bool isCancelled() const { return _cancelled; }
+        long long written() const { return _written; }
+
+        /**
+         * @brief Description of failure, valid after close()
+         */
+        QString error() const { return _error; }
+        QString path() const { return _file.fileName(); }
+
+    private:
+        virtual void append(const char *data, size_t size);
+
+        QFile _file;
+        const Format _format;
+        const UUIDEncoding _uuidEncoding;
+        const SupportedTimes _timeZone;
+        QString _error;
+        std::atomic<long long> _written;
+        std::atomic<bool> _cancelled;
+    };
+
+    typedef std::shared_ptr<ResultWriter> ResultWriterPtr;
+}
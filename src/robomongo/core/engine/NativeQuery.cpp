@@ -0,0 +1,395 @@
+#include "robomongo/core/engine/NativeQuery.h"
+
+#include <cctype>
+#include <limits>
+#include <vector>
+
+#include <mongo/db/jsobj.h>
+
+#include "robomongo/shell/bson/json.h"
+
+namespace
+{
+    const char *const spaces = " \t\r\n";
+
+    std::string trim(const std::string &text)
+    {
+        std::string::size_type from = text.find_first_not_of(spaces);
+        if (from == std::string::npos)
+            return std::string();
+
+        std::string::size_type till = text.find_last_not_of(spaces);
+        return text.substr(from, till - from + 1);
+    }
+
+    /**
+     * @brief Minimal recursive-descent reader for "db.coll.method(args).method(args)" chains.
+     * Arguments are not interpreted here, only their raw text is extracted.
+     */
+    class StatementReader
+    {
+    public:
+        explicit StatementReader(const std::string &text) : _text(text), _pos(0) {}
+
+        bool atEnd()
+        {
+            skipSpaces();
+            return _pos >= _text.size();
+        }
+
+        bool peek(char c)
+        {
+            skipSpaces();
+            return _pos < _text.size() && _text[_pos] == c;
+        }
+
+        bool consume(char c)
+        {
+            if (!peek(c))
+                return false;
+
+            ++_pos;
+            return true;
+        }
+
+        bool identifier(std::string &out)
+        {
+            skipSpaces();
+            size_t start = _pos;
+            if (_pos < _text.size() && isIdentifierStart(_text[_pos])) {
+                ++_pos;
+                while (_pos < _text.size() && isIdentifierPart(_text[_pos]))
+                    ++_pos;
+            }
+
+            out = _text.substr(start, _pos - start);
+            return !out.empty();
+        }
+
+        /**
+         * @brief Reads arguments of call until matching ')'. Opening '(' should
+         * be already consumed. Returns raw text of every top-level argument.
+         */
+        bool arguments(std::vector<std::string> &out)
+        {
+            out.clear();
+
+            int depth = 0;
+            size_t argStart = _pos;
+            char prev = '(';    // last significant character
+
+            while (_pos < _text.size()) {
+                char c = _text[_pos];
+
+                if (c == '"' || c == '\'') {
+                    if (!skipString(c))
+                        return false;
+                    prev = c;
+                    continue;
+                }
+
+                if (c == '/') {
+                    // Comments and division are not supported, only regular expression literals
+                    bool regexAllowed = (prev == '(' || prev == ':' || prev == ',' || prev == '[' || prev == '{');
+                    if (!regexAllowed || !skipRegex())
+                        return false;
+                    prev = '/';
+                    continue;
+                }
+
+                if (c == '(' || c == '[' || c == '{') {
+                    ++depth;
+                }
+                else if (c == ')' || c == ']' || c == '}') {
+                    if (depth == 0) {
+                        if (c != ')')
+                            return false;
+
+                        std::string last = trim(_text.substr(argStart, _pos - argStart));
+                        ++_pos;
+
+                        // f() has no arguments, but f(a, ) is not supported
+                        if (last.empty())
+                            return out.empty();
+
+                        out.push_back(last);
+                        return true;
+                    }
+                    --depth;
+                }
+                else if (c == ',' && depth == 0) {
+                    std::string arg = trim(_text.substr(argStart, _pos - argStart));
+                    if (arg.empty())
+                        return false;
+
+                    out.push_back(arg);
+                    argStart = _pos + 1;
+                }
+
+                if (!isspace(static_cast<unsigned char>(c)))
+                    prev = c;
+
+                ++_pos;
+            }
+
+            return false;
+        }
+
+    private:
+        static bool isIdentifierStart(char c)
+        {
+            return isalpha(static_cast<unsigned char>(c)) || c == '_' || c == '$';
+        }
+
+        static bool isIdentifierPart(char c)
+        {
+            return isIdentifierStart(c) || isdigit(static_cast<unsigned char>(c));
+        }
+
+        void skipSpaces()
+        {
+            while (_pos < _text.size() && isspace(static_cast<unsigned char>(_text[_pos])))
+                ++_pos;
+        }
+
+        bool skipString(char quote)
+        {
+            ++_pos;
+            while (_pos < _text.size()) {
+                char c = _text[_pos];
+                if (c == '\\') {
+                    _pos += 2;
+                }
+                else if (c == quote) {
+                    ++_pos;
+                    return true;
+                }
+                else if (c == '\n') {
+                    return false;
+                }
+                else {
+                    ++_pos;
+                }
+            }
+            return false;
+        }
+
+        bool skipRegex()
+        {
+            // "//" and "/*" are comments
+            if (_pos + 1 < _text.size() && (_text[_pos + 1] == '/' || _text[_pos + 1] == '*'))
+                return false;
+
+            ++_pos;
+            bool inClass = false;
+            while (_pos < _text.size()) {
+                char c = _text[_pos];
+                if (c == '\\') {
+                    _pos += 2;
+                    continue;
+                }
+
+                if (c == '\n')
+                    return false;
+
+                ++_pos;
+                if (c == '[') {
+                    inClass = true;
+                }
+                else if (c == ']') {
+                    inClass = false;
+                }
+                else if (c == '/' && !inClass) {
+                    // flags
+                    while (_pos < _text.size() && isalpha(static_cast<unsigned char>(_text[_pos])))
+                        ++_pos;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        const std::string &_text;
+        size_t _pos;
+    };
+
+    /**
+     * @brief Parses JavaScript literal (object, array, number, string, ObjectId(...) etc.)
+     * Returns false if 'text' is not a literal (i.e. references variables or calls functions).
+     */
+    bool parseLiteral(const std::string &text, mongo::BSONObj &holder, mongo::BSONElement &out)
+    {
+        std::string wrapped = "{v:" + text + "}";
+        try {
+            int len = 0;
+            holder = mongo::Robomongo::fromjson(wrapped.c_str(), &len);
+
+            // Whole text should be consumed by parser
+            if (wrapped.find_first_not_of(spaces, len) != std::string::npos)
+                return false;
+        }
+        catch (...) {
+            return false;
+        }
+
+        out = holder.firstElement();
+        return !out.eoo() && holder.nFields() == 1;
+    }
+
+    bool parseObject(const std::string &text, mongo::BSONObj &out)
+    {
+        mongo::BSONObj holder;
+        mongo::BSONElement elem;
+        if (!parseLiteral(text, holder, elem) || elem.type() != mongo::Object)
+            return false;
+
+        out = elem.Obj().getOwned();
+        return true;
+    }
+
+    bool parseArray(const std::string &text, mongo::BSONObj &out)
+    {
+        mongo::BSONObj holder;
+        mongo::BSONElement elem;
+        if (!parseLiteral(text, holder, elem) || elem.type() != mongo::Array)
+            return false;
+
+        out = elem.Obj().getOwned();
+        return true;
+    }
+
+    bool parseString(const std::string &text, std::string &out)
+    {
+        mongo::BSONObj holder;
+        mongo::BSONElement elem;
+        if (!parseLiteral(text, holder, elem) || elem.type() != mongo::String)
+            return false;
+
+        out = elem.String();
+        return !out.empty();
+    }
+
+    bool parseInt(const std::string &text, int &out)
+    {
+        mongo::BSONObj holder;
+        mongo::BSONElement elem;
+        if (!parseLiteral(text, holder, elem) || !elem.isNumber())
+            return false;
+
+        double value = elem.numberDouble();
+        if (value != static_cast<int>(value) ||
+            value < std::numeric_limits<int>::min() || value > std::numeric_limits<int>::max())
+            return false;
+
+        out = static_cast<int>(value);
+        return true;
+    }
+}
+
+namespace Robomongo
+{
+    NativeQuery::NativeQuery() :
+        _kind(Find),
+        _limit(0),
+        _skip(0) {}
+
+    bool NativeQuery::parse(const std::string &script, NativeQuery &out)
+    {
+        StatementReader reader(script);
+        NativeQuery query;
+        std::vector<std::string> args;
+        std::string name;
+        std::string method;
+
+        if (!reader.identifier(name) || name != "db" || !reader.consume('.') || !reader.identifier(name))
+            return false;
+
+        if (name == "getCollection") {
+            if (!reader.consume('(') || !reader.arguments(args) || args.size() != 1 ||
+                !parseString(args[0], query._collection))
+                return false;
+
+            if (!reader.consume('.') || !reader.identifier(method))
+                return false;
+        }
+        else {
+            // Sub-collections are accessed as db.coll.sub
+            std::string collection = name;
+            for (;;) {
+                if (!reader.consume('.') || !reader.identifier(name))
+                    return false;
+
+                if (reader.peek('(')) {
+                    method = name;
+                    break;
+                }
+
+                collection += "." + name;
+            }
+            query._collection = collection;
+        }
+
+        if (!reader.consume('(') || !reader.arguments(args))
+            return false;
+
+        if (method == "find") {
+            query._kind = Find;
+            if (args.size() > 2)
+                return false;
+
+            if (args.size() > 0 && !parseObject(args[0], query._filter))
+                return false;
+
+            if (args.size() > 1 && !parseObject(args[1], query._fields))
+                return false;
+
+            // Cursor modifiers
+            while (reader.consume('.')) {
+                if (!reader.identifier(method) || !reader.consume('(') || !reader.arguments(args))
+                    return false;
+
+                if (method == "count" && args.empty()) {
+                    // Same as in shell, count() ignores skip and limit by default
+                    query._kind = Count;
+                    break;
+                }
+
+                bool recognized =
+                    (method == "sort" && args.size() == 1 && parseObject(args[0], query._sort)) ||
+                    (method == "limit" && args.size() == 1 && parseInt(args[0], query._limit)) ||
+                    (method == "skip" && args.size() == 1 && parseInt(args[0], query._skip)) ||
+                    (method == "pretty" && args.empty());
+
+                if (!recognized)
+                    return false;
+            }
+        }
+        else if (method == "count") {
+            query._kind = Count;
+            if (args.size() > 1)
+                return false;
+
+            if (args.size() == 1 && !parseObject(args[0], query._filter))
+                return false;
+        }
+        else if (method == "aggregate") {
+            query._kind = Aggregate;
+            if (args.size() != 1 || !parseArray(args[0], query._pipeline))
+                return false;
+        }
+        else {
+            return false;
+        }
+
+        // Negative limit (single batch) and negative skip are left to the shell
+        if (query._limit < 0 || query._skip < 0)
+            return false;
+
+        reader.consume(';');
+        if (!reader.atEnd())
+            return false;
+
+        out = query;
+        return true;
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <string>
+#include <mongo/bson/bsonobj.h>
+
+namespace Robomongo
+{
+    /**
+     * @brief Single-statement find/count/aggregate call with literal arguments, i.e.:
+     *
+     *     db.coll.find({...}, {...}).sort({...}).skip(n).limit(n)
+     *     db.coll.find({...}).count()
+     *     db.coll.count({...})
+     *     db.getCollection('coll').aggregate([...])
+     *
+     * Such statements can be executed directly through MongoClient without
+     * running them in JavaScript engine. Anything else is rejected by parse()
+     * and should be executed by JavaScript engine as usual.
+     */
+    struct NativeQuery
+    {
+        enum Kind
+        {
+            Find,
+            Count,
+            Aggregate
+        };
+
+        NativeQuery();
+
+        /**
+         * @brief Returns true and fills 'out' if 'script' is recognized statement.
+         * Never throws.
+         */
+        static bool parse(const std::string &script, NativeQuery &out);
+
+        Kind _kind;
+        std::string _collection;
+        mongo::BSONObj _filter;
+        mongo::BSONObj _fields;
+        mongo::BSONObj _sort;
+        mongo::BSONObj _pipeline; // array
+        int _limit;
+        int _skip;
+    };
+}
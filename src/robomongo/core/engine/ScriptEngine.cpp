@@ -1,5 +1,7 @@
 #include "robomongo/core/engine/ScriptEngine.h"
 
+#include <algorithm>
+
 #include <QVector> // unable to put this include below. doesn't compile on GCC 4.7.2 and Qt 4.8
 #include <QDir>
 #include <QStringList>
@@ -7,6 +9,8 @@
 #include <QTextStream>
 #include <QFile>
 #include <QElapsedTimer>
+#include <QSemaphore>
+#include <QThread>
 
 // v0.9
 //#include <third_party/js-1.7/jsapi.h>
@@ -30,6 +34,8 @@
 #include "robomongo/core/settings/ConnectionSettings.h"
 #include "robomongo/core/settings/CredentialSettings.h"
 #include "robomongo/core/domain/MongoDocument.h"
+#include "robomongo/core/engine/NativeQuery.h"
+#include "robomongo/core/mongodb/MongoClient.h"
 #include "robomongo/core/utils/QtUtils.h"
 
 namespace
@@ -46,6 +52,61 @@ namespace
         output.push_back(s.substr(prev_pos, pos-prev_pos)); // Last word
         return output;
     }
+
+    /**
+     * @brief Every shell tab runs its own ScriptEngine (own scope, own connection) in the
+     * thread of its own MongoWorker. The MongoDB shell still keeps some state process-wide:
+     * connect string used by scope init callback, global script engine and buffers
+     * (__objects, __type, __logs) where print(), printjson() and shell results are captured.
+     * Access to this state is serialized with this mutex. Script execution itself is not,
+     * except for scripts that print while they run (see mayPrint).
+     * Mutex is recursive, because result of such script is captured while it is still held.
+     */
+    QMutex &shellGlobalsMutex()
+    {
+        static QMutex mutex(QMutex::Recursive);
+        return mutex;
+    }
+
+    /**
+     * @brief Bounded pool of execution slots shared by all ScriptEngines.
+     * Limits number of scripts executed concurrently to the number of cores (at least 4).
+     */
+    QSemaphore &executionSlots()
+    {
+        static QSemaphore slots(std::max(4, QThread::idealThreadCount()));
+        return slots;
+    }
+
+    struct ExecutionSlotLocker
+    {
+        ExecutionSlotLocker() { executionSlots().acquire(); }
+        ~ExecutionSlotLocker() { executionSlots().release(); }
+    };
+
+    /**
+     * @brief Whether script may write to __logs or __objects while it runs: print(),
+     * printjson(), help and status helpers, shellHelper and loaded files all print.
+     * Such scripts hold shellGlobalsMutex for their whole run. Functions defined
+     * elsewhere (e.g. in .robomongorc.js) that print are not detected.
+     */
+    bool mayPrint(const std::string &script)
+    {
+        static const char *const printing[] = { "print", "help", "status", "shellHelper", "load" };
+        for (size_t i = 0; i < sizeof(printing) / sizeof(printing[0]); ++i) {
+            if (script.find(printing[i]) != std::string::npos)
+                return true;
+        }
+        return false;
+    }
+
+    void clearCapturedOutput()
+    {
+        __objects.clear();
+        __type = "";
+        __finished = false;
+        __logs.str("");
+    }
 }
 
 namespace mongo {
@@ -60,6 +121,7 @@ namespace Robomongo
         _scope(nullptr),
         _engine(NULL),
         _timeoutSec(timeoutSec),
+        _batchSize(50),
         _initialized(false),
         _mutex(QMutex::Recursive) { }
 
@@ -91,6 +153,8 @@ namespace Robomongo
                << _connection->primaryCredential()->userPassword() << "')";
 
         {
+            QMutexLocker globalsLock(&shellGlobalsMutex());
+
             mongo::shell_utils::_dbConnect = ss.str();
             mongo::shell_utils::_dbAuth = "(function() { \nDB.prototype._defaultGssapiServiceName = \"mongodb\";\n}())";
 
@@ -119,6 +183,9 @@ namespace Robomongo
                 _scope->execFile(QtUtils::toStdString(robomongorcPath), false, false);
             }
             _failedScope = false;
+
+            // Drop whatever rc-files printed, so it doesn't leak into the first result
+            clearCapturedOutput();
         }
 
         // Esprima ECMAScript parser: http://esprima.org/
@@ -151,7 +218,8 @@ namespace Robomongo
         _initialized = true;
     }
 
-    MongoShellExecResult ScriptEngine::exec(const std::string &originalScript, const std::string &dbName)
+    MongoShellExecResult ScriptEngine::exec(const std::string &originalScript, const std::string &dbName,
+                                            mongo::DBClientBase *connection /* = nullptr */)
     {
         QMutexLocker lock(&_mutex);
 
@@ -160,6 +228,11 @@ namespace Robomongo
             return MongoShellExecResult(true, "Connection error. Uninitialized mongo scope.");
         }
 
+        // Simple find/count/aggregate statements do not need JavaScript engine
+        MongoShellExecResult nativeResult;
+        if (execNative(originalScript, dbName, connection, nativeResult))
+            return nativeResult;
+
         // robomongo shell timeout
         bool timeoutReached = false;
 
@@ -188,42 +261,65 @@ namespace Robomongo
 
         std::vector<MongoShellResult> results;
 
+        // Take one of the shared execution slots for the whole script
+        ExecutionSlotLocker slot;
+
         use(dbName);
 
+        const bool printing = mayPrint(stdstr);
+
         for (std::vector<std::string>::const_iterator it = statements.begin(); it != statements.end(); ++it)
         {
             std::string statement = *it;
-            // clear global objects
-            __objects.clear();
-            __type = "";
-            __finished = false;
-            __logs.str("");
 
             if (true /* ! wascmd */) {
                 try {
                     bool failed = false;
                     QElapsedTimer timer;
-                    timer.start();
-                    if ( _scope->exec( statement , "(shell)" , false , true , false, _timeoutSec * 1000) ) {
-                         _scope->exec( "__robomongoLastRes = __lastres__; shellPrintHelper( __lastres__ );", 
-                                      "(shell2)" , true , true , false, _timeoutSec * 1000);
+
+                    std::string answer;
+                    std::string type;
+                    std::vector<mongo::BSONObj> objects;
+                    {
+                        // Scripts that print keep other tabs off the global buffers while they run,
+                        // others run in parallel and take the lock only to print their result
+                        QMutexLocker printingLock(printing ? &shellGlobalsMutex() : nullptr);
+                        timer.start();
+
+                        // Errors are taken from exception instead of being reported into global __logs
+                        bool executed = false;
+                        std::string error;
+                        try {
+                            executed = _scope->exec( statement , "(shell)" , false , false , true, _timeoutSec * 1000);
+                        }
+                        catch (const std::exception &ex) {
+                            error = ex.what();
+                        }
+
+                        QMutexLocker globalsLock(&shellGlobalsMutex());
+
+                        if (executed) {
+                             _scope->exec( "__robomongoLastRes = __lastres__; shellPrintHelper( __lastres__ );", 
+                                          "(shell2)" , true , true , false, _timeoutSec * 1000);
+                        }
+                        else   // failed to run script 
+                            failed = true;
+
+                        answer = __logs.str() + error;
+                        type = __type.c_str();
+                        objects.swap(__objects);
+                        clearCapturedOutput();
                     }
-                    else   // failed to run script 
-                        failed = true;                                            
 
                     qint64 elapsed = timer.elapsed();   // milliseconds 
 
                     if (elapsed > _timeoutSec * 1000)
                         timeoutReached = true;
 
-                    std::string logs = __logs.str();
-                    std::string answer = logs.c_str();
-                    std::string type = __type.c_str();
-
                     if (failed && !timeoutReached)
                         return MongoShellExecResult(true, answer);
 
-                    std::vector<MongoDocumentPtr> docs = MongoDocument::fromBsonObj(__objects);
+                    std::vector<MongoDocumentPtr> docs = MongoDocument::fromBsonObj(objects);
 
                     if (!answer.empty() || docs.size() > 0)
                         results.push_back(prepareResult(type, answer, docs, elapsed));
@@ -237,6 +333,78 @@ namespace Robomongo
         return prepareExecResult(results, timeoutReached);
     }
 
+    bool ScriptEngine::execNative(const std::string &script, const std::string &dbName,
+                                  mongo::DBClientBase *connection, MongoShellExecResult &result)
+    {
+        // Statement is executed against 'dbName', the same database that use() selects for JS
+        NativeQuery query;
+        if (!connection || dbName.empty() || !NativeQuery::parse(script, query))
+            return false;
+
+        // Shell reads with rs.slaveOk(), see use()
+        const int options = mongo::QueryOption_SlaveOk;
+        const std::string serverAddress = connection->getServerAddress();
+
+        // Native statements are stopped by server, as JavaScript ones are stopped by scope
+        const int maxTimeMS = _timeoutSec > 0 ? _timeoutSec * 1000 : 0;
+
+        MongoClient client(connection);
+        MongoNamespace ns(dbName, query._collection);
+        std::vector<MongoShellResult> results;
+
+        QElapsedTimer timer;
+        timer.start();
+
+        try {
+            switch (query._kind) {
+            case NativeQuery::Find: {
+                // The same shape DBQuery has after sort() and maxTimeMS(): { query: ..., orderby: ..., $maxTimeMS: ... }
+                bool special = !query._sort.isEmpty() || maxTimeMS > 0;
+                mongo::BSONObj filter = query._filter;
+                if (special) {
+                    mongo::BSONObjBuilder builder;
+                    builder.append("query", query._filter);
+                    if (!query._sort.isEmpty())
+                        builder.append("orderby", query._sort);
+                    if (maxTimeMS > 0)
+                        builder.append("$maxTimeMS", maxTimeMS);
+                    filter = builder.obj();
+                }
+
+                MongoQueryInfo info(CollectionInfo(serverAddress, dbName, query._collection),
+                                    filter, query._fields, query._limit, query._skip, _batchSize, options, special);
+
+                // Shell prints only the first batch of cursor
+                MongoQueryInfo firstBatch(info);
+                if (firstBatch._limit == 0 || firstBatch._limit > _batchSize)
+                    firstBatch._limit = _batchSize;
+
+                std::vector<MongoDocumentPtr> docs = client.query(firstBatch);
+                results.push_back(MongoShellResult("", "", docs, info, timer.elapsed()));
+                break;
+            }
+            case NativeQuery::Count: {
+                long long count = client.count(ns, query._filter, options, maxTimeMS);
+                results.push_back(MongoShellResult("", std::to_string(count), std::vector<MongoDocumentPtr>(),
+                                                   MongoQueryInfo(), timer.elapsed()));
+                break;
+            }
+            case NativeQuery::Aggregate: {
+                std::vector<MongoDocumentPtr> docs = client.aggregateFirstBatch(ns, query._pipeline, _batchSize, options, maxTimeMS);
+                results.push_back(MongoShellResult("", "", docs, MongoQueryInfo(), timer.elapsed()));
+                break;
+            }
+            }
+        }
+        catch (const mongo::DBException &ex) {
+            result = MongoShellExecResult(true, ex.what());
+            return true;
+        }
+
+        result = MongoShellExecResult(results, serverAddress, true, dbName, true);
+        return true;
+    }
+
     void ScriptEngine::interrupt()
     {
         // This operation crash Robomongo
@@ -259,7 +427,10 @@ namespace Robomongo
             // Always allow to read from slave
             ss << "rs.slaveOk();" << std::endl;
 
+            // "switched to db ..." message is not part of any result
+            QMutexLocker globalsLock(&shellGlobalsMutex());
             _scope->exec(ss.str(), "(usedb)", false, true, false);
+            clearCapturedOutput();
         }
     }
 
@@ -267,6 +438,8 @@ namespace Robomongo
     {
         QMutexLocker lock(&_mutex);
 
+        _batchSize = batchSize;
+
         char buff[64] = {0};
         sprintf(buff, "DBQuery.shellBatchSize = %d", batchSize);
 
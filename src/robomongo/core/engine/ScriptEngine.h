@@ -7,6 +7,11 @@
 #include "robomongo/core/domain/MongoShellResult.h"
 #include "robomongo/core/Enums.h"
 
+namespace mongo
+{
+    class DBClientBase;
+}
+
 namespace Robomongo
 {
     class ConnectionSettings;
@@ -19,7 +24,13 @@ namespace Robomongo
         ~ScriptEngine();
 
         void init(bool isLoadMongoJs, const std::string& serverAddr = "", const std::string& dbName = "");
-        MongoShellExecResult exec(const std::string &script, const std::string &dbName = std::string());
+
+        /**
+         * @brief Executes script. If 'connection' is provided, simple find/count/aggregate
+         * statements (see NativeQuery) are executed through it, bypassing JavaScript engine.
+         */
+        MongoShellExecResult exec(const std::string &script, const std::string &dbName = std::string(),
+                                  mongo::DBClientBase *connection = nullptr);
         void interrupt();
 
         void use(const std::string &dbName);
@@ -39,6 +50,9 @@ namespace Robomongo
         MongoShellResult prepareResult(const std::string &type, const std::string &output, 
                                        const std::vector<MongoDocumentPtr> &objects, qint64 elapsedms);
 
+        bool execNative(const std::string &script, const std::string &dbName,
+                        mongo::DBClientBase *connection, MongoShellExecResult &result);
+
         MongoShellExecResult prepareExecResult(const std::vector<MongoShellResult> &results, 
                                                bool timeoutReached = false);
 
@@ -47,6 +61,7 @@ namespace Robomongo
         bool statementize(const std::string &script, std::vector<std::string> &outList, std::string &outError);
 
         int _timeoutSec;
+        int _batchSize;
         mongo::ScriptEngine *_engine;
         std::unique_ptr<mongo::Scope> _scope;
         bool _failedScope = false;
@@ -32,6 +32,11 @@ namespace Robomongo
     R_REGISTER_EVENT(ExecuteQueryRequest)
     R_REGISTER_EVENT(ExecuteQueryResponse)
     R_REGISTER_EVENT(DocumentListLoadedEvent)
+    R_REGISTER_EVENT(SaveQueryRequest)
+    R_REGISTER_EVENT(SaveQueryResponse)
+    R_REGISTER_EVENT(ExplainQueryRequest)
+    R_REGISTER_EVENT(ExplainQueryResponse)
+    R_REGISTER_EVENT(QueryExplainedEvent)
     R_REGISTER_EVENT(ExecuteScriptRequest)
     R_REGISTER_EVENT(ExecuteScriptResponse)
     R_REGISTER_EVENT(AutocompleteRequest)
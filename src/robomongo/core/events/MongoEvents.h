@@ -3,6 +3,8 @@
 #include <QString>
 #include <QStringList>
 #include <QEvent>
+#include <QAtomicInt>
+#include <memory>
 #include <mongo/client/dbclientinterface.h>
 
 #include "robomongo/core/domain/MongoShellResult.h"
@@ -22,6 +24,7 @@ namespace Robomongo
     class MongoWorker;
     class ConnectionSettings;
     class SshTunnelWorker;
+    class ResultWriter;
 
     /**
      * @brief EstablishConnection
@@ -176,14 +179,18 @@ namespace Robomongo
         R_EVENT
 
     public:
-        LoadCollectionNamesRequest(QObject *sender, const std::string &databaseName) :
+        LoadCollectionNamesRequest(QObject *sender, const std::string &databaseName,
+                                   const SupersessionTicket &ticket = SupersessionTicket()) :
             Event(sender),
-            _databaseName(databaseName) {}
+            _databaseName(databaseName),
+            _ticket(ticket) {}
 
         std::string databaseName() const { return _databaseName; }
+        SupersessionTicket ticket() const { return _ticket; }
 
     private:
         std::string _databaseName;
+        SupersessionTicket _ticket;
     };
 
     class LoadCollectionNamesResponse : public Event
@@ -889,17 +896,21 @@ namespace Robomongo
         R_EVENT
 
     public:
-        ExecuteQueryRequest(QObject *sender, int resultIndex, const MongoQueryInfo &queryInfo) :
+        ExecuteQueryRequest(QObject *sender, int resultIndex, const MongoQueryInfo &queryInfo,
+                            const SupersessionTicket &ticket = SupersessionTicket()) :
             Event(sender),
             _resultIndex(resultIndex),
-            _queryInfo(queryInfo) {}
+            _queryInfo(queryInfo),
+            _ticket(ticket) {}
 
         int resultIndex() const { return _resultIndex; }
         MongoQueryInfo queryInfo() const { return _queryInfo; }
+        SupersessionTicket ticket() const { return _ticket; }
 
     private:
         int _resultIndex; //external user data;
         MongoQueryInfo _queryInfo;
+        SupersessionTicket _ticket;
     };
 
     class ExecuteQueryResponse : public Event
@@ -920,33 +931,132 @@ namespace Robomongo
         std::vector<MongoDocumentPtr> documents;
     };
 
+    /**
+     * @brief Run query and write its documents to file as they come
+     */
+
+    class SaveQueryRequest : public Event
+    {
+        R_EVENT
+
+    public:
+        SaveQueryRequest(QObject *sender, const MongoQueryInfo &queryInfo, const std::shared_ptr<ResultWriter> &writer) :
+            Event(sender),
+            _queryInfo(queryInfo),
+            _writer(writer) {}
+
+        MongoQueryInfo queryInfo() const { return _queryInfo; }
+        std::shared_ptr<ResultWriter> writer() const { return _writer; }
+
+    private:
+        MongoQueryInfo _queryInfo;
+        std::shared_ptr<ResultWriter> _writer;
+    };
+
+    class SaveQueryResponse : public Event
+    {
+        R_EVENT
+
+    public:
+        SaveQueryResponse(QObject *sender, const std::shared_ptr<ResultWriter> &writer) :
+            Event(sender),
+            _writer(writer) {}
+
+        SaveQueryResponse(QObject *sender, const std::shared_ptr<ResultWriter> &writer, const EventError &error) :
+            Event(sender, error),
+            _writer(writer) {}
+
+        std::shared_ptr<ResultWriter> writer() const { return _writer; }
+
+    private:
+        std::shared_ptr<ResultWriter> _writer;
+    };
+
+    /**
+     * @brief Explain query with "executionStats" verbosity
+     */
+
+    class ExplainQueryRequest : public Event
+    {
+        R_EVENT
+
+    public:
+        ExplainQueryRequest(QObject *sender, int resultIndex, const MongoQueryInfo &queryInfo,
+                            const SupersessionTicket &ticket = SupersessionTicket()) :
+            Event(sender),
+            _resultIndex(resultIndex),
+            _queryInfo(queryInfo),
+            _ticket(ticket) {}
+
+        int resultIndex() const { return _resultIndex; }
+        MongoQueryInfo queryInfo() const { return _queryInfo; }
+        SupersessionTicket ticket() const { return _ticket; }
+
+    private:
+        int _resultIndex; //external user data;
+        MongoQueryInfo _queryInfo;
+        SupersessionTicket _ticket;
+    };
+
+    class ExplainQueryResponse : public Event
+    {
+        R_EVENT
+
+        ExplainQueryResponse(QObject *sender, int resultIndex, const mongo::BSONObj &explain) :
+            Event(sender),
+            resultIndex(resultIndex),
+            explain(explain) { }
+
+        ExplainQueryResponse(QObject *sender, int resultIndex, const EventError &error) :
+            Event(sender, error),
+            resultIndex(resultIndex) {}
+
+        int resultIndex;
+        mongo::BSONObj explain;
+    };
+
+    /**
+     * @brief Autocompletion request. Every new request of the same sender increments
+     * 'latestGeneration', so requests with older 'generation' are superseded
+     * and can be dropped before execution.
+     */
     class AutocompleteRequest : public Event
     {
         R_EVENT
 
-        AutocompleteRequest(QObject *sender, const std::string &prefix, const AutocompletionMode mode) :
+        AutocompleteRequest(QObject *sender, const std::string &prefix, const AutocompletionMode mode,
+                            int generation, const std::shared_ptr<QAtomicInt> &latestGeneration) :
             Event(sender),
             prefix(prefix),
-            mode(mode) {}
+            mode(mode),
+            generation(generation),
+            latestGeneration(latestGeneration) {}
+
+        bool isSuperseded() const { return latestGeneration && latestGeneration->load() != generation; }
 
         std::string prefix;
         AutocompletionMode mode;
+        int generation;
+        std::shared_ptr<QAtomicInt> latestGeneration;
     };
 
     class AutocompleteResponse : public Event
     {
         R_EVENT
 
-        AutocompleteResponse(QObject *sender, const QStringList &list, const std::string &prefix) :
+        AutocompleteResponse(QObject *sender, const QStringList &list, const std::string &prefix, int generation = 0) :
             Event(sender),
             list(list),
-            prefix(prefix) {}
+            prefix(prefix),
+            generation(generation) {}
 
-        AutocompleteResponse(QObject *sender, const EventError &error) :
-            Event(sender, error) {}
+        AutocompleteResponse(QObject *sender, const EventError &error, int generation = 0) :
+            Event(sender, error),
+            generation(generation) {}
 
         QStringList list;
         std::string prefix;
+        int generation;
     };
 
 
@@ -1092,6 +1202,28 @@ namespace Robomongo
         std::string _query;
     };
 
+    class QueryExplainedEvent : public Event
+    {
+        R_EVENT
+
+    public:
+        QueryExplainedEvent(QObject *sender, int resultIndex, const mongo::BSONObj &explain) :
+            Event(sender),
+            _resultIndex(resultIndex),
+            _explain(explain) { }
+
+        QueryExplainedEvent(QObject *sender, int resultIndex, const EventError &error) :
+            Event(sender, error),
+            _resultIndex(resultIndex) {}
+
+        int resultIndex() const { return _resultIndex; }
+        mongo::BSONObj explain() const { return _explain; }
+
+    private:
+        int _resultIndex;
+        mongo::BSONObj _explain;
+    };
+
     class ScriptExecutedEvent : public Event
     {
         R_EVENT
@@ -4,6 +4,21 @@
 
 namespace Robomongo
 {
+    /**
+     * @brief Identifies request that can be superseded by a newer request with the
+     * same key (see MongoWorker::supersede()). Default-constructed ticket is never superseded.
+     */
+    struct SupersessionTicket
+    {
+        SupersessionTicket() : _id(0) {}
+        SupersessionTicket(const std::string &key, long long id) : _key(key), _id(id) {}
+
+        bool isValid() const { return !_key.empty(); }
+
+        std::string _key;
+        long long _id;
+    };
+
     struct EnsureIndexInfo
     {
         EnsureIndexInfo(
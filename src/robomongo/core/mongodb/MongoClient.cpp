@@ -1,5 +1,7 @@
 #include "robomongo/core/mongodb/MongoClient.h"
 
+#include <cstring>
+
 #include "mongo/db/namespace_string.h"
 
 #include "robomongo/core/domain/MongoDocument.h"
@@ -8,6 +10,90 @@
 
 namespace
 {
+    /**
+     * @brief $replaceRoot stage that replaces long strings and large arrays on the first level
+     * of document with { __truncated: <length>, value: <beginning of string or array> }.
+     * _id is never truncated, it is used to edit, remove and load full document.
+     * Requires MongoDB 3.4 ($replaceRoot, $objectToArray, $switch).
+     */
+    mongo::BSONObj truncationStage(int stringLength, int arraySize)
+    {
+        using namespace Robomongo;
+
+        // $and stops at the first false expression, so $strLenCP and $size get only valid types
+        mongo::BSONObj isLongString = BSON("$and" << BSON_ARRAY(
+            BSON("$eq" << BSON_ARRAY(BSON("$type" << "$$field.v") << "string")) <<
+            BSON("$gt" << BSON_ARRAY(BSON("$strLenCP" << "$$field.v") << stringLength))));
+
+        mongo::BSONObj isLargeArray = BSON("$and" << BSON_ARRAY(
+            BSON("$isArray" << BSON_ARRAY("$$field.v")) <<
+            BSON("$gt" << BSON_ARRAY(BSON("$size" << "$$field.v") << arraySize))));
+
+        mongo::BSONObj truncatedString = BSON(
+            BsonUtils::truncatedMarker << BSON("$strLenCP" << "$$field.v") <<
+            "value" << BSON("$substrCP" << BSON_ARRAY("$$field.v" << 0 << stringLength)));
+
+        mongo::BSONObj truncatedArray = BSON(
+            BsonUtils::truncatedMarker << BSON("$size" << "$$field.v") <<
+            "value" << BSON("$slice" << BSON_ARRAY("$$field.v" << arraySize)));
+
+        mongo::BSONObj value = BSON("$switch" << BSON(
+            "branches" << BSON_ARRAY(
+                BSON("case" << BSON("$eq" << BSON_ARRAY("$$field.k" << "_id")) << "then" << "$$field.v") <<
+                BSON("case" << isLongString << "then" << truncatedString) <<
+                BSON("case" << isLargeArray << "then" << truncatedArray)) <<
+            "default" << "$$field.v"));
+
+        mongo::BSONObj fields = BSON("$map" << BSON(
+            "input" << BSON("$objectToArray" << "$$ROOT") <<
+            "as" << "field" <<
+            "in" << BSON("k" << "$$field.k" << "v" << value)));
+
+        return BSON("$replaceRoot" << BSON("newRoot" << BSON("$arrayToObject" << fields)));
+    }
+
+    /**
+     * @brief Whether filter uses operators that are not allowed in $match stage
+     * ($where, geo $near queries) or are restricted there ($text)
+     */
+    bool hasNonMatchOperators(const mongo::BSONObj &filter)
+    {
+        mongo::BSONObjIterator it(filter);
+        while (it.more()) {
+            mongo::BSONElement elem = it.next();
+            const char *name = elem.fieldName();
+            if (name[0] == '$' && (!strcmp(name, "$where") || !strcmp(name, "$near") ||
+                                   !strcmp(name, "$nearSphere") || !strcmp(name, "$text")))
+                return true;
+
+            if ((elem.type() == mongo::Object || elem.type() == mongo::Array) && hasNonMatchOperators(elem.Obj()))
+                return true;
+        }
+        return false;
+    }
+
+    void throwCommandError(const mongo::BSONObj &result)
+    {
+        std::string errStr = result.getStringField("errmsg");
+        if (errStr.empty())
+            errStr = "Failed to get error message.";
+
+        throw mongo::DBException(errStr, 0);
+    }
+
+    /**
+     * @brief Appends documents of 'firstBatch' or 'nextBatch' array of command cursor
+     */
+    void appendBatch(std::vector<Robomongo::MongoDocumentPtr> &docs, const mongo::BSONObj &batch)
+    {
+        mongo::BSONObjIterator it(batch);
+        while (it.more()) {
+            mongo::BSONElement elem = it.next();
+            if (elem.type() == mongo::Object)
+                docs.push_back(Robomongo::MongoDocumentPtr(new Robomongo::MongoDocument(elem.Obj().getOwned())));
+        }
+    }
+
     Robomongo::EnsureIndexInfo makeEnsureIndexInfoFromBsonObj(
         const Robomongo::MongoCollectionInfo &collection,
         const mongo::BSONObj &obj)
@@ -17,7 +103,7 @@ namespace
         info._name = getField<mongo::String>(obj, "name");
         mongo::BSONObj keyObj = getField<mongo::Object>(obj, "key");
         if (keyObj.isValid()) {
-            info._request = jsonString(keyObj, mongo::TenGen, 1, Robomongo::DefaultEncoding, Robomongo::Utc);
+            info._request = jsonString(keyObj, TenGenJson, 1, Robomongo::DefaultEncoding, Robomongo::Utc);
         }
         info._unique = getField<mongo::Bool>(obj, "unique");
         info._backGround = getField<mongo::Bool>(obj, "background");
@@ -28,7 +114,7 @@ namespace
         info._languageOverride = getField<mongo::String>(obj, "language_override");
         mongo::BSONObj weightsObj = getField<mongo::Object>(obj, "weights");
         if (weightsObj.isValid()) {
-            info._textWeights = jsonString(weightsObj, mongo::TenGen, 1, Robomongo::DefaultEncoding, Robomongo::Utc);
+            info._textWeights = jsonString(weightsObj, TenGenJson, 1, Robomongo::DefaultEncoding, Robomongo::Utc);
         }
         return info;
     }
@@ -546,7 +632,8 @@ namespace Robomongo
         checkLastErrorAndThrow(ns.databaseName());
     }
 
-    std::vector<MongoDocumentPtr> MongoClient::query(const MongoQueryInfo &info)
+    std::vector<MongoDocumentPtr> MongoClient::query(const MongoQueryInfo &info,
+                                                     const std::function<bool()> &isCancelled)
     {
         MongoNamespace ns(info._info._ns);
 
@@ -557,6 +644,11 @@ namespace Robomongo
         if (info._limit == -1) // it means that we do not need to load any documents
             return docs;
 
+        // Values are truncated by aggregation, when server and filter allow it
+        if (info._truncateValues && _dbclient->getMaxWireVersion() >= minTruncationWireVersion &&
+            !hasNonMatchOperators(mongo::Query(info._query).getFilter()))
+            return queryTruncated(info, isCancelled);
+
         std::unique_ptr<mongo::DBClientCursor> cursor = _dbclient->query(
             ns.toString(), info._query, info._limit, info._skip,
             info._fields.nFields() ? &info._fields : 0, info._options, info._batchSize);
@@ -569,6 +661,179 @@ namespace Robomongo
             mongo::BSONObj bsonObj = cursor->next();
             MongoDocumentPtr doc(new MongoDocument(bsonObj.getOwned()));
             docs.push_back(doc);
+
+            // Do not issue getMore for cancelled query. Cursor is killed in destructor.
+            if (isCancelled && !cursor->moreInCurrentBatch() && isCancelled())
+                break;
+        }
+
+        return docs;
+    }
+
+    void MongoClient::queryEach(const MongoQueryInfo &info, const std::function<bool(const mongo::BSONObj &)> &onDocument)
+    {
+        if (info._limit == -1)
+            return;
+
+        MongoNamespace ns(info._info._ns);
+        std::unique_ptr<mongo::DBClientCursor> cursor = _dbclient->query(
+            ns.toString(), info._query, info._limit, info._skip,
+            info._fields.nFields() ? &info._fields : 0, info._options, info._batchSize);
+
+        if (!cursor)
+            throw mongo::DBException("Network error while attempting to run query", 0);
+
+        // Cursor is killed in destructor when loop stops early
+        while (cursor->more()) {
+            if (!onDocument(cursor->next()))
+                break;
+        }
+    }
+
+    std::vector<MongoDocumentPtr> MongoClient::queryTruncated(const MongoQueryInfo &info,
+                                                              const std::function<bool()> &isCancelled)
+    {
+        // mongo::Query understands both plain filters and "special" queries
+        mongo::Query query(info._query);
+
+        mongo::BSONArrayBuilder pipeline;
+        pipeline.append(BSON("$match" << query.getFilter()));
+
+        mongo::BSONObj sort = query.getSort();
+        if (!sort.isEmpty())
+            pipeline.append(BSON("$sort" << sort));
+
+        if (info._skip > 0)
+            pipeline.append(BSON("$skip" << info._skip));
+
+        if (info._limit > 0)
+            pipeline.append(BSON("$limit" << info._limit));
+
+        if (info._fields.nFields())
+            pipeline.append(BSON("$project" << info._fields));
+
+        pipeline.append(truncationStage(truncatedStringLength, truncatedArraySize));
+
+        // Page usually comes in the first batch, but batch is limited to 16 MB and binary
+        // values are not truncated, so the rest of page is read with getMore
+        int batchSize = info._limit > 0 ? info._limit : info._batchSize;
+        return aggregate(info._info._ns, pipeline.arr(), batchSize, info._options, 0, isCancelled);
+    }
+
+    mongo::BSONObj MongoClient::explain(const MongoQueryInfo &info)
+    {
+        MongoNamespace ns(info._info._ns);
+
+        // mongo::Query understands both plain filters and "special" queries
+        // (i.e. { query: ..., orderby: ... }) produced by the shell
+        mongo::Query query(info._query);
+
+        mongo::BSONObjBuilder find;
+        find.append("find", ns.collectionName());
+        find.append("filter", query.getFilter());
+
+        mongo::BSONObj sort = query.getSort();
+        if (!sort.isEmpty())
+            find.append("sort", sort);
+
+        mongo::BSONObj hint = query.getHint();
+        if (!hint.isEmpty())
+            find.append("hint", hint);
+
+        if (info._fields.nFields())
+            find.append("projection", info._fields);
+
+        if (info._skip > 0)
+            find.append("skip", info._skip);
+
+        if (info._limit > 0)
+            find.append("limit", info._limit);
+
+        // Building { explain: { find: <collection>, ... }, verbosity: "executionStats" }
+        mongo::BSONObjBuilder command;
+        command.append("explain", find.obj());
+        command.append("verbosity", "executionStats");
+
+        mongo::BSONObj result;
+        if (!_dbclient->runCommand(ns.databaseName(), command.obj(), result)) {
+            std::string errStr = result.getStringField("errmsg");
+            if (errStr.empty())
+                errStr = "Failed to get error message.";
+
+            throw mongo::DBException(errStr, 0);
+        }
+
+        return result.getOwned();
+    }
+
+    long long MongoClient::count(const MongoNamespace &ns, const mongo::BSONObj &filter, int options, int maxTimeMS)
+    {
+        if (maxTimeMS <= 0)
+            return _dbclient->count(ns.toString(), filter, options);
+
+        // Building { count: <collection>, query: <filter>, maxTimeMS: <maxTimeMS> }
+        mongo::BSONObjBuilder command;
+        command.append("count", ns.collectionName());
+        command.append("query", filter);
+        command.append("maxTimeMS", maxTimeMS);
+
+        mongo::BSONObj result;
+        if (!_dbclient->runCommand(ns.databaseName(), command.obj(), result, options))
+            throwCommandError(result);
+
+        return result.getField("n").numberLong();
+    }
+
+    std::vector<MongoDocumentPtr> MongoClient::aggregateFirstBatch(const MongoNamespace &ns, const mongo::BSONObj &pipeline,
+                                                                   int batchSize, int options, int maxTimeMS)
+    {
+        // Rest of results is not needed, server-side cursor is released after the first batch
+        return aggregate(ns, pipeline, batchSize, options, maxTimeMS, []() { return true; });
+    }
+
+    std::vector<MongoDocumentPtr> MongoClient::aggregate(const MongoNamespace &ns, const mongo::BSONObj &pipeline,
+                                                         int batchSize, int options, int maxTimeMS,
+                                                         const std::function<bool()> &isCancelled)
+    {
+        // Building { aggregate: <collection>, pipeline: [...], cursor: { batchSize: <batchSize> } }
+        mongo::BSONObjBuilder command;
+        command.append("aggregate", ns.collectionName());
+        command.appendArray("pipeline", pipeline);
+        command.append("cursor", BSON("batchSize" << batchSize));
+        if (maxTimeMS > 0)
+            command.append("maxTimeMS", maxTimeMS);
+
+        mongo::BSONObj result;
+        if (!_dbclient->runCommand(ns.databaseName(), command.obj(), result, options))
+            throwCommandError(result);
+
+        mongo::BSONObj cursor = result.getObjectField("cursor");
+
+        std::vector<MongoDocumentPtr> docs;
+        appendBatch(docs, cursor.getObjectField("firstBatch"));
+
+        long long cursorId = cursor.getField("id").numberLong();
+        while (cursorId != 0) {
+            // Do not issue getMore for cancelled query, release server-side cursor
+            if (isCancelled && isCancelled()) {
+                _dbclient->killCursor(cursorId);
+                break;
+            }
+
+            // Building { getMore: <cursor id>, collection: <collection>, batchSize: <batchSize> }
+            mongo::BSONObjBuilder getMore;
+            getMore.append("getMore", cursorId);
+            getMore.append("collection", ns.collectionName());
+            getMore.append("batchSize", batchSize);
+
+            if (!_dbclient->runCommand(ns.databaseName(), getMore.obj(), result, options)) {
+                _dbclient->killCursor(cursorId);
+                throwCommandError(result);
+            }
+
+            cursor = result.getObjectField("cursor");
+            appendBatch(docs, cursor.getObjectField("nextBatch"));
+            cursorId = cursor.getField("id").numberLong();
         }
 
         return docs;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <mongo/client/dbclientinterface.h>
 #include <mongo/bson/bsonobj.h>
 
@@ -49,7 +50,49 @@ namespace Robomongo
         void insertDocument(const mongo::BSONObj &obj, const MongoNamespace &ns);
         void saveDocument(const mongo::BSONObj &obj, const MongoNamespace &ns);
         void removeDocuments(const MongoNamespace &ns, mongo::Query query, bool justOne = true);
-        std::vector<MongoDocumentPtr> query(const MongoQueryInfo &info);
+
+        enum { truncatedStringLength = 1000 };  // in characters (code points)
+        enum { truncatedArraySize = 100 };      // in elements
+        enum { minTruncationWireVersion = 5 };  // MongoDB 3.4, see queryTruncated()
+
+        /**
+         * @brief Loads documents. If 'isCancelled' returns true, loading stops before next
+         * batch is requested and server-side cursor is killed.
+         *
+         * When 'info._truncateValues' is set, query runs as aggregation that replaces long
+         * top-level strings and arrays with truncated values (see BsonUtils::isTruncated).
+         * Servers older than 3.4 and filters not allowed in $match ($where, $near, $nearSphere,
+         * $text) are queried as usual, values are not truncated then.
+         */
+        std::vector<MongoDocumentPtr> query(const MongoQueryInfo &info,
+                                            const std::function<bool()> &isCancelled = std::function<bool()>());
+
+        /**
+         * @brief Runs query and passes documents to 'onDocument' one by one, as they come
+         * from server, without keeping them. Values are never truncated. Stops when
+         * 'onDocument' returns false, server-side cursor is killed then.
+         */
+        void queryEach(const MongoQueryInfo &info, const std::function<bool(const mongo::BSONObj &)> &onDocument);
+
+        /**
+         * @brief Runs { explain: { find: ... }, verbosity: "executionStats" } for the
+         * query described by 'info' and returns raw explain output.
+         */
+        mongo::BSONObj explain(const MongoQueryInfo &info);
+
+        /**
+         * @brief Counts documents matching 'filter'. When 'maxTimeMS' is positive, server
+         * stops the operation after that time and error is thrown.
+         */
+        long long count(const MongoNamespace &ns, const mongo::BSONObj &filter, int options = 0, int maxTimeMS = 0);
+
+        /**
+         * @brief Runs aggregation and returns only its first batch (at most 'batchSize' documents),
+         * the same amount of documents that shell prints for aggregation cursor.
+         * When 'maxTimeMS' is positive, server stops the operation after that time.
+         */
+        std::vector<MongoDocumentPtr> aggregateFirstBatch(const MongoNamespace &ns, const mongo::BSONObj &pipeline,
+                                                          int batchSize, int options = 0, int maxTimeMS = 0);
 
         MongoCollectionInfo runCollStatsCommand(const std::string &ns);
         std::vector<MongoCollectionInfo> runCollStatsCommand(const std::vector<std::string> &namespaces);
@@ -59,5 +102,13 @@ namespace Robomongo
     private:
         mongo::DBClientBase *const _dbclient;
         void checkLastErrorAndThrow(const std::string &db);
+        std::vector<MongoDocumentPtr> queryTruncated(const MongoQueryInfo &info, const std::function<bool()> &isCancelled);
+
+        /**
+         * @brief Runs aggregation and reads all its batches
+         */
+        std::vector<MongoDocumentPtr> aggregate(const MongoNamespace &ns, const mongo::BSONObj &pipeline,
+                                                int batchSize, int options, int maxTimeMS,
+                                                const std::function<bool()> &isCancelled);
     };
 }
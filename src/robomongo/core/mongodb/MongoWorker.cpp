@@ -18,6 +18,7 @@
 #include "robomongo/core/settings/ReplicaSetSettings.h"
 #include "robomongo/core/domain/MongoShellResult.h"
 #include "robomongo/core/domain/MongoCollectionInfo.h"
+#include "robomongo/core/domain/ResultWriter.h"
 #include "robomongo/core/settings/CredentialSettings.h"
 #include "robomongo/core/settings/SettingsManager.h"
 #include "robomongo/core/settings/SslSettings.h"
@@ -43,7 +44,8 @@ namespace Robomongo
         _isQuiting(0),
         _dbclient(nullptr),
         _dbclientRepSet(nullptr),
-        _connSettings(connection)
+        _connSettings(connection),
+        _lastTicketId(0)
     {
         _thread = new QThread();
         moveToThread(_thread);
@@ -137,6 +139,35 @@ namespace Robomongo
         _scriptEngine->changeTimeout(newTimeout);
     }
 
+    SupersessionTicket MongoWorker::supersede(const std::string &key)
+    {
+        QMutexLocker lock(&_supersessionMutex);
+        SupersessionTicket ticket(key, ++_lastTicketId);
+        _latestTickets[key] = ticket._id;
+        return ticket;
+    }
+
+    bool MongoWorker::isSuperseded(const SupersessionTicket &ticket) const
+    {
+        if (!ticket.isValid())
+            return false;
+
+        QMutexLocker lock(&_supersessionMutex);
+        auto it = _latestTickets.find(ticket._key);
+        return it != _latestTickets.end() && it->second != ticket._id;
+    }
+
+    void MongoWorker::releaseTicket(const SupersessionTicket &ticket)
+    {
+        if (!ticket.isValid())
+            return;
+
+        QMutexLocker lock(&_supersessionMutex);
+        auto it = _latestTickets.find(ticket._key);
+        if (it != _latestTickets.end() && it->second == ticket._id)
+            _latestTickets.erase(it);
+    }
+
     /**
      * @brief Initiate connection to MongoDB
      */
@@ -348,15 +379,27 @@ namespace Robomongo
      */
     void MongoWorker::handle(LoadCollectionNamesRequest *event)
     {
+        if (isSuperseded(event->ticket()))
+            return;
+
         try {
             boost::scoped_ptr<MongoClient> client(getClient());
 
             auto const& namespaces = client->getCollectionNamesWithDbname(event->databaseName());
+            if (isSuperseded(event->ticket()))
+                return;
+
             std::vector<MongoCollectionInfo> const& collInfos = client->runCollStatsCommand(namespaces);
             client->done();
 
+            if (isSuperseded(event->ticket()))
+                return;
+
+            releaseTicket(event->ticket());
             reply(event->sender(), new LoadCollectionNamesResponse(this, event->databaseName(), collInfos));
         } catch(const mongo::DBException &ex) {
+            releaseTicket(event->ticket());
+
             if (_connSettings->isReplicaSet()) {
                 ReplicaSet const& replicaSetInfo = getReplicaSetInfo(true);
                 if (replicaSetInfo.primary.empty()) {  // primary not reachable
@@ -548,18 +591,74 @@ namespace Robomongo
 
     void MongoWorker::handle(ExecuteQueryRequest *event)
     {
+        // Newer request for the same result (i.e. user clicked "next page" again)
+        // is already in the queue
+        SupersessionTicket const ticket = event->ticket();
+        if (isSuperseded(ticket))
+            return;
+
         try {
             boost::scoped_ptr<MongoClient> client(getClient());
-            std::vector<MongoDocumentPtr> docs = client->query(event->queryInfo());
+            std::vector<MongoDocumentPtr> docs = client->query(event->queryInfo(), [this, &ticket]() {
+                return isSuperseded(ticket);
+            });
             client->done();
 
+            if (isSuperseded(ticket))
+                return;
+
+            releaseTicket(ticket);
             reply(event->sender(), new ExecuteQueryResponse(this, event->resultIndex(), event->queryInfo(), docs));
         } catch(const mongo::DBException &ex) {
+            releaseTicket(ticket);
             reply(event->sender(), new ExecuteQueryResponse(this, EventError(ex.what())));
             LOG_MSG(ex.what(), mongo::logger::LogSeverity::Error());
         }
     }
 
+    void MongoWorker::handle(SaveQueryRequest *event)
+    {
+        ResultWriterPtr writer = event->writer();
+        try {
+            boost::scoped_ptr<MongoClient> client(getClient());
+            client->queryEach(event->queryInfo(), [&writer](const mongo::BSONObj &obj) {
+                return writer->write(obj);
+            });
+            client->done();
+
+            writer->close();
+            reply(event->sender(), new SaveQueryResponse(this, writer));
+        } catch(const mongo::DBException &ex) {
+            // Incomplete file is removed
+            writer->cancel();
+            writer->close();
+            reply(event->sender(), new SaveQueryResponse(this, writer, EventError(ex.what())));
+            LOG_MSG(ex.what(), mongo::logger::LogSeverity::Error());
+        }
+    }
+
+    void MongoWorker::handle(ExplainQueryRequest *event)
+    {
+        if (isSuperseded(event->ticket()))
+            return;
+
+        try {
+            boost::scoped_ptr<MongoClient> client(getClient());
+            mongo::BSONObj explain = client->explain(event->queryInfo());
+            client->done();
+
+            if (isSuperseded(event->ticket()))
+                return;
+
+            releaseTicket(event->ticket());
+            reply(event->sender(), new ExplainQueryResponse(this, event->resultIndex(), explain));
+        } catch(const mongo::DBException &ex) {
+            releaseTicket(event->ticket());
+            reply(event->sender(), new ExplainQueryResponse(this, event->resultIndex(), EventError(ex.what())));
+            LOG_MSG(ex.what(), mongo::logger::LogSeverity::Error());
+        }
+    }
+
     /**
      * @brief Execute javascript
      */
@@ -584,7 +683,9 @@ namespace Robomongo
             }
 
             // todo: should we use dbName from event or _connSettings? 
-            MongoShellExecResult result = _scriptEngine->exec(event->script, _connSettings->defaultDatabase());
+            // Worker's connection is used to run simple queries without JavaScript engine
+            MongoShellExecResult result = _scriptEngine->exec(event->script, _connSettings->defaultDatabase(),
+                                                              getConnection(true));
 
             // To fix the problem where 'result' comes with old primary address.
             if (_connSettings->isReplicaSet()) 
@@ -643,15 +744,20 @@ namespace Robomongo
     void MongoWorker::handle(AutocompleteRequest *event)
     {
         try {
+            // User already typed more, result of this request will be discarded anyway
+            if (event->isSuperseded())
+                return;
+
             if (!_scriptEngine) {
-                reply(event->sender(), new AutocompleteResponse(this, EventError("MongoDB Shell was not initialized")));
+                reply(event->sender(), new AutocompleteResponse(this, EventError("MongoDB Shell was not initialized"),
+                                                                event->generation));
                 return;
             }
 
             QStringList list = _scriptEngine->complete(event->prefix, event->mode);
-            reply(event->sender(), new AutocompleteResponse(this, list, event->prefix));
+            reply(event->sender(), new AutocompleteResponse(this, list, event->prefix, event->generation));
         } catch(const mongo::DBException &ex) {
-            reply(event->sender(), new AutocompleteResponse(this, EventError(ex.what())));
+            reply(event->sender(), new AutocompleteResponse(this, EventError(ex.what()), event->generation));
             LOG_MSG(ex.what(), mongo::logger::LogSeverity::Error());
         }
     }
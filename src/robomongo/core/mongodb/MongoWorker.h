@@ -2,6 +2,7 @@
 
 #include <QObject>
 #include <QMutex>
+#include <unordered_map>
 #include <unordered_set>
 
 #include <mongo/client/dbclient_rs.h> 
@@ -38,6 +39,15 @@ namespace Robomongo
         void stopAndDelete();
         void changeTimeout(int newTimeout);
 
+        /**
+         * @brief Registers new request with supersession 'key' (i.e. shell and result index for paging,
+         * database for list of collections). All earlier requests with the same key, pending in the
+         * queue or in-flight, become superseded and are dropped without reply.
+         * Thread-safe, should be called by requester right before sending the request.
+         */
+        SupersessionTicket supersede(const std::string &key);
+        bool isSuperseded(const SupersessionTicket &ticket) const;
+
     protected Q_SLOTS:
 
         void init();
@@ -114,6 +124,16 @@ namespace Robomongo
          */
         void handle(ExecuteQueryRequest *event);
 
+        /**
+         * @brief Run query and write its documents to file (used by "Save Result to File")
+         */
+        void handle(SaveQueryRequest *event);
+
+        /**
+         * @brief Explain query (used by "Explain" custom output mode)
+         */
+        void handle(ExplainQueryRequest *event);
+
         /**
          * @brief Execute javascript
          */
@@ -191,6 +211,11 @@ namespace Robomongo
         */
         void pingDatabase(mongo::DBClientBase *dbclient) const;
 
+        /**
+         * @brief Forgets 'ticket' when its request is completed (unless it was already superseded)
+         */
+        void releaseTicket(const SupersessionTicket &ticket);
+
         QThread *_thread;
         QMutex _firstConnectionMutex;
 
@@ -216,6 +241,11 @@ namespace Robomongo
         // We save all created databases in this collection and merge with
         // list of real databases returned from MongoDB server.
         std::unordered_set<std::string> _createdDbs;
+
+        // Latest ticket id for every supersession key
+        mutable QMutex _supersessionMutex;
+        std::unordered_map<std::string, long long> _latestTickets;
+        long long _lastTicketId;
     };
 
 }
@@ -98,6 +98,7 @@ namespace Robomongo
         _viewMode(Robomongo::Tree),
         _autocompletionMode(AutocompleteAll),
         _loadMongoRcJs(false),
+        _truncateLongValues(false),
         _minimizeToTray(false),
         _lineNumbers(false),
         _disableConnectionShortcuts(false),
@@ -212,6 +213,7 @@ namespace Robomongo
         }
 
         _autoExpand = map.contains("autoExpand") ? map.value("autoExpand").toBool() : true;
+        _truncateLongValues = map.contains("truncateLongValues") ? map.value("truncateLongValues").toBool() : false;
         _autoExec = map.contains("autoExec") ? map.value("autoExec").toBool() : true;
         _minimizeToTray = map.contains("minimizeToTray") ? map.value("minimizeToTray").toBool() : false;
         _lineNumbers = map.contains("lineNumbers") ? map.value("lineNumbers").toBool() : false;
@@ -334,6 +336,7 @@ namespace Robomongo
         // 4. Save view mode
         map.insert("viewMode", _viewMode);
         map.insert("autoExpand", _autoExpand);
+        map.insert("truncateLongValues", _truncateLongValues);
         map.insert("lineNumbers", _lineNumbers);
 
         // 5. Save Autocompletion mode
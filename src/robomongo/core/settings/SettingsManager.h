@@ -143,6 +143,13 @@ namespace Robomongo
         void setAutoExpand(bool isExpand) { _autoExpand = isExpand; }
         bool autoExpand() const { return _autoExpand; }
 
+        /**
+         * @brief When enabled, paged queries return long strings and large arrays
+         * truncated on server (see MongoClient::query)
+         */
+        void setTruncateLongValues(bool isTruncate) { _truncateLongValues = isTruncate; }
+        bool truncateLongValues() const { return _truncateLongValues; }
+
         void setAutoExec(bool isAutoExec) { _autoExec = isAutoExec; }
         bool autoExec() const { return _autoExec; }
 
@@ -232,6 +239,7 @@ namespace Robomongo
         AutocompletionMode _autocompletionMode;
         bool _loadMongoRcJs;
         bool _autoExpand;
+        bool _truncateLongValues;
         bool _autoExec;
         bool _minimizeToTray;
         bool _lineNumbers;
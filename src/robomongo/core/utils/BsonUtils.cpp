@@ -1,10 +1,17 @@
 #include "robomongo/core/utils/BsonUtils.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
 #include <mongo/client/dbclientinterface.h>
 //#include <mongo/bson/bsonobjiterator.h>
 #include "mongo/util/base64.h"
 #include "mongo/util/stringutils.h"
 
+#include "robomongo/core/utils/DateUtils.h"
+#include "robomongo/core/utils/EscapeUtils.h"
+#include "robomongo/core/utils/NumberUtils.h"
 #include "robomongo/core/utils/QtUtils.h"
 #include "robomongo/core/HexUtils.h"
 
@@ -12,6 +19,81 @@
 #include "robomongo/shell/db/ptimeutil.h"
 
 using namespace mongo;
+
+namespace
+{
+    const char hexDigits[] = "0123456789abcdef";
+    const char base64Digits[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    // Relaxed Extended JSON writes dates of years 1970..9999 as ISO-8601 strings
+    const long long maxIsoDate = 253402300800000LL; // "10000-01-01T00:00:00.000Z"
+
+    void appendIndent(std::string &out, int level)
+    {
+        if (level > 0)
+            out.append(4 * level, ' ');
+    }
+
+    /**
+     * @brief Adapter of JsonSink for writeJson(): text is written to buffer,
+     * and is passed to sink in chunks of about 'chunkSize' bytes
+     */
+    class SinkBuffer
+    {
+    public:
+        enum { chunkSize = 64 * 1024 };
+
+        explicit SinkBuffer(Robomongo::BsonUtils::JsonSink &sink) : _sink(sink) { _text.reserve(chunkSize * 2); }
+        std::string &text() { return _text; }
+
+        void flush()
+        {
+            if (!_text.empty())
+                _sink.append(_text.data(), _text.size());
+            _text.clear();
+        }
+
+    private:
+        Robomongo::BsonUtils::JsonSink &_sink;
+        std::string _text;
+    };
+
+    std::string &textOf(std::string &out) { return out; }
+    std::string &textOf(SinkBuffer &out) { return out.text(); }
+
+    void written(std::string &) {}
+    void written(SinkBuffer &out)
+    {
+        if (out.text().size() >= SinkBuffer::chunkSize)
+            out.flush();
+    }
+
+    void appendBase64(std::string &out, const char *data, int length)
+    {
+        const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data);
+        const size_t start = out.size();
+        out.resize(start + (length + 2) / 3 * 4);
+        char *dest = &out[start];
+
+        int i = 0;
+        for (; i + 2 < length; i += 3) {
+            const unsigned int triple = (bytes[i] << 16) | (bytes[i + 1] << 8) | bytes[i + 2];
+            *dest++ = base64Digits[(triple >> 18) & 0x3F];
+            *dest++ = base64Digits[(triple >> 12) & 0x3F];
+            *dest++ = base64Digits[(triple >> 6) & 0x3F];
+            *dest++ = base64Digits[triple & 0x3F];
+        }
+
+        if (i < length) {
+            const unsigned int triple = (bytes[i] << 16) | (i + 1 < length ? bytes[i + 1] << 8 : 0);
+            *dest++ = base64Digits[(triple >> 18) & 0x3F];
+            *dest++ = base64Digits[(triple >> 12) & 0x3F];
+            *dest++ = i + 1 < length ? base64Digits[(triple >> 6) & 0x3F] : '=';
+            *dest++ = '=';
+        }
+    }
+}
+
 namespace Robomongo
 {
     namespace BsonUtils
@@ -61,9 +143,31 @@ namespace Robomongo
             }
         }
 
-        std::string jsonString(const BSONObj &obj, JsonStringFormat format, int pretty, UUIDEncoding uuidEncoding, SupportedTimes timeFormat, bool isArray)
+        std::string jsonString(const BSONObj &obj, JsonFormat format, int pretty, UUIDEncoding uuidEncoding, SupportedTimes timeFormat, bool isArray)
         {
-            using namespace std;
+            std::string result;
+            result.reserve(obj.objsize());
+            writeJson(result, obj, format, pretty, uuidEncoding, timeFormat, isArray);
+            return result;
+        }
+
+        std::string jsonString(const BSONElement &elem, JsonFormat format, bool includeFieldNames, 
+                               int pretty, UUIDEncoding uuidEncoding, SupportedTimes timeFormat, bool isArray)
+        {
+            std::string result;
+            writeJson(result, elem, format, includeFieldNames, pretty, uuidEncoding, timeFormat, isArray);
+            return result;
+        }
+
+        template <typename Sink>
+        void writeElement(Sink &sink, const BSONElement &elem, JsonFormat format, bool includeFieldNames,
+                          int pretty, UUIDEncoding uuidEncoding, SupportedTimes timeFormat, bool isArray);
+
+        template <typename Sink>
+        void writeObject(Sink &sink, const BSONObj &obj, JsonFormat format, int pretty,
+                         UUIDEncoding uuidEncoding, SupportedTimes timeFormat, bool isArray)
+        {
+            std::string &out = textOf(sink);
 
             // Use of method, that is implemented in Robomongo Shell
             // Method "isArray()" is not part of MongoDB.
@@ -75,246 +179,296 @@ namespace Robomongo
             }
 
             if ( obj.isEmpty() ) {
-                return isArray? "[]" : "{}";
+                out.append(isArray ? "[]" : "{}", 2);
+                return;
             }
 
-            StringBuilder s;
-            s << (isArray ? "[" : "{");
+            out += isArray ? '[' : '{';
             BSONObjIterator i(obj);
             BSONElement e = i.next();
 
             if ( !e.eoo() ) {
                 while ( 1 ) {
                     if ( pretty ) {
-                        s << '\n';
-                        for( int x = 0; x < pretty; x++ ) {
-                            s << "    ";
-                        }
+                        out += '\n';
+                        appendIndent(out, pretty);
                     }
                     else {
-                        s << " ";
+                        out += ' ';
                     }
 
-                    s << jsonString(e, format, true, pretty ? pretty + 1 : 0, uuidEncoding, timeFormat, isArray);
+                    writeElement(sink, e, format, true, pretty ? pretty + 1 : 0, uuidEncoding, timeFormat, isArray);
                     e = i.next();
 
                     if (e.eoo()) {
-                        s << '\n';
-                        for( int x = 0; x < pretty - 1; x++ ) {
-                            s << "    ";
+                        if ( pretty ) {
+                            out += '\n';
+                            appendIndent(out, pretty - 1);
+                        }
+                        else {
+                            out += ' ';
                         }
-                        s << (isArray ? "]" : "}");
+                        out += isArray ? ']' : '}';
                         break;
                     }
 
-                    s << ",";
+                    out += ',';
                 }
             }
-            return s.str();
         }
 
-        std::string jsonString(const BSONElement &elem, JsonStringFormat format, bool includeFieldNames, 
-                               int pretty, UUIDEncoding uuidEncoding, SupportedTimes timeFormat, bool isArray)
+        template <typename Sink>
+        void writeElement(Sink &sink, const BSONElement &elem, JsonFormat format, bool includeFieldNames,
+                          int pretty, UUIDEncoding uuidEncoding, SupportedTimes timeFormat, bool isArray)
         {
-            using namespace std;
-            BSONType t = elem.type();            
-
-            std::stringstream s;
-            if ( includeFieldNames && !isArray)
-                s << '"' << escape( elem.fieldName() ) << "\" : ";
+            std::string &out = textOf(sink);
+            BSONType t = elem.type();
+            const bool relaxed = format == RelaxedJson;
+            // Strict and relaxed formats are valid JSON, types without JSON equivalent are wrapped
+            const bool extended = relaxed || format == StrictJson;
+
+            if ( includeFieldNames && !isArray) {
+                out += '"';
+                EscapeUtils::appendEscaped(out, elem.fieldName(), elem.fieldNameSize() - 1);
+                out.append("\" : ", 4);
+            }
 
             switch ( t ) {
             case Undefined:
-                s << "undefined";
+                out.append(extended ? "{ \"$undefined\" : true }" : "undefined");
                 break;
-            case mongo::String:
             case Symbol:
-                s << '"' << escape( std::string(elem.valuestr(), elem.valuestrsize()-1) ) << '"';
+                if (relaxed) {
+                    out.append("{ \"$symbol\" : \"");
+                    EscapeUtils::appendEscaped(out, elem.valuestr(), elem.valuestrsize() - 1);
+                    out.append("\" }");
+                    break;
+                }
+            case mongo::String:
+                out += '"';
+                EscapeUtils::appendEscaped(out, elem.valuestr(), elem.valuestrsize() - 1);
+                out += '"';
                 break;
             case NumberLong:
-                s << "NumberLong(" << elem._numberLong() << ")";
+                if (relaxed) {
+                    NumberUtils::appendInteger(out, elem._numberLong());
+                    break;
+                }
+                if (extended) {
+                    out.append("{ \"$numberLong\" : \"");
+                    NumberUtils::appendInteger(out, elem._numberLong());
+                    out.append("\" }");
+                    break;
+                }
+                out.append("NumberLong(");
+                NumberUtils::appendInteger(out, elem._numberLong());
+                out += ')';
                 break;
             case NumberInt:
-                s << elem._numberInt();
+                NumberUtils::appendInteger(out, elem._numberInt());
                 break;
             case NumberDouble:
-                {
-                    int sign = 0;
-                    if ( elem.number() >= -std::numeric_limits< double >::max() &&
-                            elem.number() <= std::numeric_limits< double >::max() ) {
-
-                        // was 16
-                        s.precision(std::numeric_limits<double>::digits10);
-                        s << elem.number();
-
-                        // Leave trailing zero if needed
-                        if (elem.number() == (long long)elem.number())
-                            s << ".0";
-                    }
-                    else if (std::isnan(elem.number()) ) {
-                        s << "NaN";
-                    }
-                    else if (std::isinf(elem.number()) ) {
-                        s << "Infinity";
-//                        s << ( sign == 1 ? "Infinity" : "-Infinity");
-                    }
-                    else {
-                        StringBuilder ss;
-                        ss << "Number " << elem.number() << " cannot be represented in JSON";
-                        string message = ss.str();
-                        //massert( 10311 ,  message.c_str(), false );
-                    }
+                // NaN and infinities are not JSON numbers
+                if (relaxed && !std::isfinite(elem._numberDouble())) {
+                    out.append("{ \"$numberDouble\" : \"");
+                    NumberUtils::appendDouble(out, elem._numberDouble());
+                    out.append("\" }");
                     break;
                 }
+                NumberUtils::appendDouble(out, elem._numberDouble());
+                break;
             case NumberDecimal:
-                s << "NumberDecimal(\"" << elem._numberDecimal().toString() << "\")";
+                out.append(extended ? "{ \"$numberDecimal\" : \"" : "NumberDecimal(\"");
+                out.append(elem._numberDecimal().toString());
+                out.append(extended ? "\" }" : "\")");
                 break;
             case mongo::Bool:
-                s << ( elem.boolean() ? "true" : "false" );
+                out.append( elem.boolean() ? "true" : "false" );
                 break;
             case jstNULL:
-                s << "null";
+                out.append("null");
                 break;
-            case Object: {
-                BSONObj obj = elem.embeddedObject();
-                s << jsonString(obj, format, pretty, uuidEncoding, timeFormat);
-                }
+            case Object:
+                writeObject(sink, elem.embeddedObject(), format, pretty, uuidEncoding, timeFormat, false);
                 break;
             case mongo::Array: {
                 if ( elem.embeddedObject().isEmpty() ) {
-                    s << "[]";
+                    out.append("[]");
                     break;
                 }
-                s << "[ ";
+                out.append("[ ");
                 BSONObjIterator i( elem.embeddedObject() );
                 BSONElement e = i.next();
                 if ( !e.eoo() ) {
                     int count = 0;
                     while ( 1 ) {
                         if ( pretty ) {
-                            s << '\n';
-                            for( int x = 0; x < pretty; x++ )
-                                s << "    ";
+                            out += '\n';
+                            appendIndent(out, pretty);
                         }
 
                         if (strtol(e.fieldName(), 0, 10) > count) {
-                            s << "undefined";
+                            out.append(extended ? "{ \"$undefined\" : true }" : "undefined");
                         }
                         else {
-                            s << jsonString(e, format, false, pretty ? pretty + 1 : 0, uuidEncoding, timeFormat, true);
+                            writeElement(sink, e, format, false, pretty ? pretty + 1 : 0, uuidEncoding, timeFormat, true);
                             e = i.next();
                         }
                         count++;
                         if ( e.eoo() ) {
-                            s << '\n';
-                            for( int x = 0; x < pretty - 1; x++ )
-                                s << "    ";
-                            s << "]";
+                            if ( pretty ) {
+                                out += '\n';
+                                appendIndent(out, pretty - 1);
+                            }
+                            else {
+                                out += ' ';
+                            }
+                            out += ']';
                             break;
                         }
-                        s << ", ";
+                        out.append(", ");
                     }
                 }
-                //s << " ]";
                 break;
             }
             case DBRef: {
-                mongo::OID *x = (mongo::OID *) (elem.valuestr() + elem.valuestrsize());
-                if ( format == TenGen )
-                    s << "DBRef(";
+                const char *id = elem.valuestr() + elem.valuestrsize();
+                if (relaxed) {
+                    out.append("{ \"$dbPointer\" : { \"$ref\" : \"");
+                    EscapeUtils::appendEscaped(out, elem.valuestr(), elem.valuestrsize() - 1);
+                    out.append("\", \"$id\" : { \"$oid\" : \"");
+                    HexUtils::appendHexLower(out, id, OID::kOIDSize);
+                    out.append("\" } } }");
+                    break;
+                }
+                if ( format == TenGenJson )
+                    out.append("DBRef(");
                 else
-                    s << "{ \"$ref\" : ";
-                s << '"' << elem.valuestr() << "\", ";
-                if ( format != TenGen )
-                    s << "\"$id\" : ";
-                s << '"' << *x << "\"";
-                if ( format == TenGen )
-                    s << ')';
+                    out.append("{ \"$ref\" : ");
+                out += '"';
+                out.append(elem.valuestr());
+                out.append("\", ");
+                if ( format != TenGenJson )
+                    out.append("\"$id\" : ");
+                out += '"';
+                HexUtils::appendHexLower(out, id, OID::kOIDSize);
+                out += '"';
+                if ( format == TenGenJson )
+                    out += ')';
                 else
-                    s << '}';
+                    out += '}';
                 break;
             }
             case jstOID:
-                if ( format == TenGen ) {
-                    s << "ObjectId(";
+                if ( format == TenGenJson ) {
+                    out.append("ObjectId(");
                 }
                 else {
-                    s << "{ \"$oid\" : ";
+                    out.append("{ \"$oid\" : ");
                 }
-                s << '"' << elem.__oid() << '"';
-                if ( format == TenGen ) {
-                    s << ")";
+                out += '"';
+                HexUtils::appendHexLower(out, elem.value(), OID::kOIDSize);
+                out += '"';
+                if ( format == TenGenJson ) {
+                    out += ')';
                 }
                 else {
-                    s << " }";
+                    out.append(" }");
                 }
                 break;
             case BinData: {
                 int len = *(int *)( elem.value() );
                 BinDataType type = BinDataType( *(char *)( (int *)( elem.value() ) + 1 ) );
 
-                if (type == mongo::bdtUUID || type == mongo::newUUID) {
-                    s << HexUtils::formatUuid(elem, uuidEncoding);
+                if (!extended && (type == mongo::bdtUUID || type == mongo::newUUID) && len == HexUtils::uuidBytes) {
+                    HexUtils::appendUuid(out, elem, uuidEncoding);
                     break;
                 }
 
-                s << "{ \"$binary\" : \"";
-                char *start = ( char * )( elem.value() ) + sizeof( int ) + 1;
-                base64::encode( s , start , len );
-                s << "\", \"$type\" : \"" << hex;
-                s.width( 2 );
-                s.fill( '0' );
-                s << type << dec;
-                s << "\" }";
+                out.append(relaxed ? "{ \"$binary\" : { \"base64\" : \"" : "{ \"$binary\" : \"");
+                const char *start = elem.value() + sizeof( int ) + 1;
+                appendBase64(out, start, len);
+                out.append(relaxed ? "\", \"subType\" : \"" : "\", \"$type\" : \"");
+                out += hexDigits[(type >> 4) & 0xF];
+                out += hexDigits[type & 0xF];
+                out.append(relaxed ? "\" } }" : "\" }");
                 break;
             }
             case mongo::Date:
                 {
                     Date_t d = elem.date();
-                    long long ms = d.toMillisSinceEpoch(); //static_cast<long long>(d.millis);
+                    long long ms = d.toMillisSinceEpoch();
+
+                    if (relaxed) {
+                        if (0 <= ms && ms < maxIsoDate) {
+                            out.append("{ \"$date\" : \"");
+                            DateUtils::appendIsoDate(out, ms, true, false);
+                            out.append("\" }");
+                        }
+                        else {
+                            out.append("{ \"$date\" : { \"$numberLong\" : \"");
+                            NumberUtils::appendInteger(out, ms);
+                            out.append("\" } }");
+                        }
+                        break;
+                    }
+
                     bool isSupportedDate = miutil::minDate < ms && ms < miutil::maxDate;
 
-                    if ( format == Strict )
-                        s << "{ \"$date\" : ";
+                    if ( format == StrictJson )
+                        out.append("{ \"$date\" : ");
                     else{
                         if (isSupportedDate) {
-                            s << "ISODate(";
+                            out.append("ISODate(");
                         }
                         else{
-                            s << "Date(";
+                            out.append("Date(");
                         }
                     }
 
                     if ( pretty && isSupportedDate) {
-                        boost::posix_time::ptime epoch(boost::gregorian::date(1970, 1, 1));
-                        boost::posix_time::time_duration diff = boost::posix_time::millisec(ms);
-                        boost::posix_time::ptime time = epoch + diff;
-                        std::string timestr = miutil::isotimeString(time, true, timeFormat == LocalTime);
-                        s << '"' << timestr << '"';
+                        out += '"';
+                        DateUtils::appendIsoDate(out, ms, true, timeFormat == LocalTime);
+                        out += '"';
                     }
                     else
-                        s << ms;
+                        NumberUtils::appendInteger(out, ms);
 
-                    if ( format == Strict )
-                        s << " }";
+                    if ( format == StrictJson )
+                        out.append(" }");
                     else
-                        s << ")";
+                        out += ')';
                     break;
                 }
             case RegEx:
-                if ( format == Strict ) {
-                    s << "{ \"$regex\" : \"" << escape( elem.regex() );
-                    s << "\", \"$options\" : \"" << elem.regexFlags() << "\" }";
+                if (relaxed) {
+                    // Options are in alphabetical order
+                    std::string options = elem.regexFlags();
+                    std::sort(options.begin(), options.end());
+                    out.append("{ \"$regularExpression\" : { \"pattern\" : \"");
+                    EscapeUtils::appendEscaped(out, elem.regex(), strlen(elem.regex()));
+                    out.append("\", \"options\" : \"");
+                    out.append(options);
+                    out.append("\" } }");
+                }
+                else if ( format == StrictJson ) {
+                    out.append("{ \"$regex\" : \"");
+                    EscapeUtils::appendEscaped(out, elem.regex(), strlen(elem.regex()));
+                    out.append("\", \"$options\" : \"");
+                    out.append(elem.regexFlags());
+                    out.append("\" }");
                 }
                 else {
-                    s << "/" << escape( elem.regex() , true ) << "/";
+                    out += '/';
+                    EscapeUtils::appendEscaped(out, elem.regex(), strlen(elem.regex()), true);
+                    out += '/';
                     // FIXME Worry about alpha order?
                     for ( const char *f = elem.regexFlags(); *f; ++f ) {
                         switch ( *f ) {
                         case 'g':
                         case 'i':
                         case 'm':
-                            s << *f;
+                            out += *f;
                         default:
                             break;
                         }
@@ -325,40 +479,150 @@ namespace Robomongo
             case CodeWScope: {
                 BSONObj scope = elem.codeWScopeObject();
                 if ( ! scope.isEmpty() ) {
-                    s << "{ \"$code\" : " << elem._asCode() << " , "
-                      << " \"$scope\" : " << scope.jsonString() << " }";
+                    if (extended) {
+                        // Scope is written on one line, as in shell format
+                        const std::string code = elem._asCode();
+                        out.append("{ \"$code\" : \"");
+                        EscapeUtils::appendEscaped(out, code.data(), code.size());
+                        out.append("\", \"$scope\" : ");
+                        writeObject(sink, scope, format, 0, uuidEncoding, timeFormat, false);
+                        out.append(" }");
+                        break;
+                    }
+                    out.append("{ \"$code\" : ");
+                    out.append(elem._asCode());
+                    out.append(" ,  \"$scope\" : ");
+                    out.append(scope.jsonString());
+                    out.append(" }");
                     break;
                 }
             }
 
             case Code:
-                s << elem._asCode();
+                if (extended) {
+                    const std::string code = elem._asCode();
+                    out.append("{ \"$code\" : \"");
+                    EscapeUtils::appendEscaped(out, code.data(), code.size());
+                    out.append("\" }");
+                    break;
+                }
+                out.append(elem._asCode());
                 break;
 
             case bsonTimestamp:
-                if ( format == TenGen )
-                    s << "Timestamp(" << elem.timestamp().getSecs() << ", " << elem.timestampInc() << ")";
-                else 
-                    s << "{ \"$timestamp\" : { \"t\" : " << elem.timestamp().getSecs() << ", \"i\" : " 
-                      << elem.timestampInc() << " } }";
+                if ( format == TenGenJson ) {
+                    out.append("Timestamp(");
+                    NumberUtils::appendInteger(out, elem.timestamp().getSecs());
+                    out.append(", ");
+                    NumberUtils::appendInteger(out, elem.timestampInc());
+                    out += ')';
+                }
+                else {
+                    out.append("{ \"$timestamp\" : { \"t\" : ");
+                    NumberUtils::appendInteger(out, elem.timestamp().getSecs());
+                    out.append(", \"i\" : ");
+                    NumberUtils::appendInteger(out, elem.timestampInc());
+                    out.append(" } }");
+                }
                 break;
 
             case MinKey:
-                s << "{ \"$minKey\" : 1 }";
+                out.append("{ \"$minKey\" : 1 }");
                 break;
 
             case MaxKey:
-                s << "{ \"$maxKey\" : 1 }";
+                out.append("{ \"$maxKey\" : 1 }");
                 break;
 
             default:
-                StringBuilder ss;
-                ss << "Cannot create a properly formatted JSON string with "
-                   << "element: " << elem.toString() << " of type: " << elem.type();
+                // Cannot create a properly formatted JSON string with element of this type
+                break;
             }
-            return s.str();
+
+            // Values are complete here, buffered text can be passed on
+            written(sink);
+        }
+
+        void writeJson(std::string &out, const BSONObj &obj, JsonFormat format, int pretty,
+                       UUIDEncoding uuidEncoding, SupportedTimes timeFormat, bool isArray)
+        {
+            writeObject(out, obj, format, pretty, uuidEncoding, timeFormat, isArray);
+        }
+
+        void writeJson(std::string &out, const BSONElement &elem, JsonFormat format, bool includeFieldNames,
+                       int pretty, UUIDEncoding uuidEncoding, SupportedTimes timeFormat, bool isArray)
+        {
+            writeElement(out, elem, format, includeFieldNames, pretty, uuidEncoding, timeFormat, isArray);
         }
-    
+
+        void writeJson(JsonSink &sink, const BSONObj &obj, JsonFormat format, int pretty,
+                       UUIDEncoding uuidEncoding, SupportedTimes timeFormat, bool isArray)
+        {
+            SinkBuffer buffer(sink);
+            writeObject(buffer, obj, format, pretty, uuidEncoding, timeFormat, isArray);
+            buffer.flush();
+        }
+
+        void writeJson(JsonSink &sink, const BSONElement &elem, JsonFormat format, bool includeFieldNames,
+                       int pretty, UUIDEncoding uuidEncoding, SupportedTimes timeFormat, bool isArray)
+        {
+            SinkBuffer buffer(sink);
+            writeElement(buffer, elem, format, includeFieldNames, pretty, uuidEncoding, timeFormat, isArray);
+            buffer.flush();
+        }
+
+        int jsonLineBreaks(const BSONObj &obj)
+        {
+            if (obj.isEmpty())
+                return 0;
+
+            // Every field starts on new line, closing bracket too
+            int count = 1;
+            BSONObjIterator i(obj);
+            while (i.more())
+                count += 1 + jsonLineBreaks(i.next());
+
+            return count;
+        }
+
+        int jsonLineBreaks(const BSONElement &elem)
+        {
+            switch (elem.type()) {
+            case Object:
+                return jsonLineBreaks(elem.embeddedObject());
+            case mongo::Array: {
+                if (elem.embeddedObject().isEmpty())
+                    return 0;
+
+                // Same walk as in writeJson(), missing elements are written as "undefined"
+                int count = 0;
+                int index = 0;
+                BSONObjIterator i(elem.embeddedObject());
+                BSONElement e = i.next();
+                while (1) {
+                    ++count;
+                    if (strtol(e.fieldName(), 0, 10) <= index) {
+                        count += jsonLineBreaks(e);
+                        e = i.next();
+                    }
+                    ++index;
+                    if (e.eoo())
+                        return count + 1;
+                }
+            }
+            case DBRef:
+                return std::count(elem.valuestr(), elem.valuestr() + elem.valuestrsize() - 1, '\n');
+            case Code:
+            case CodeWScope: {
+                // Code is written as is
+                const std::string code = elem._asCode();
+                return std::count(code.begin(), code.end(), '\n');
+            }
+            default:
+                return 0;
+            }
+        }
+
         bool isArray(const mongo::BSONElement &elem)
         {
             return isArray(elem.type());
@@ -585,15 +849,7 @@ namespace Robomongo
             {
             case NumberDouble:
                 {
-                    std::stringstream s;
-                    s.precision(std::numeric_limits<double>::digits10);
-                    s << elem.Double();
-
-                    // Leave trailing zero if needed
-                    if (elem.Double() == (long long)elem.Double())
-                        s << ".0";
-
-                    con.append(s.str());
+                    NumberUtils::appendDouble(con, elem.Double());
                 }
                 break;
             case String:
@@ -614,9 +870,8 @@ namespace Robomongo
             case BinData:
                 {
                     mongo::BinDataType binType = elem.binDataType();
-                    if (binType == mongo::newUUID || binType == mongo::bdtUUID) {
-                        std::string uu = HexUtils::formatUuid(elem, uuid);
-                        con.append(uu);
+                    if ((binType == mongo::newUUID || binType == mongo::bdtUUID) && elem.valuestrsize() == HexUtils::uuidBytes) {
+                        HexUtils::appendUuid(con, elem, uuid);
                         break;
                     }
                     con.append("<binary>");
@@ -641,17 +896,10 @@ namespace Robomongo
                     long long ms = (long long) elem.Date().toMillisSinceEpoch();
                     bool isSupportedDate = miutil::minDate < ms && ms < miutil::maxDate;
 
-                    boost::posix_time::ptime epoch(boost::gregorian::date(1970, 1, 1));
-                    boost::posix_time::time_duration diff = boost::posix_time::millisec(ms);
-                    boost::posix_time::ptime time = epoch + diff;
-
-                    std::string date;
                     if (isSupportedDate)
-                        date = miutil::isotimeString(time, false, tz == LocalTime);
+                        DateUtils::appendIsoDate(con, ms, false, tz == LocalTime);
                     else
-                        date = boost::lexical_cast<std::string>(ms);
-
-                    con.append(date);
+                        NumberUtils::appendInteger(con, ms);
                     break;
                 }
             case jstNULL:
@@ -692,12 +940,8 @@ namespace Robomongo
                 }
                 break;
             case NumberInt:
-                {
-                    char num[16] = {0};
-                    sprintf(num, "%d", elem.Int());
-                    con.append(num);
-                    break;
-                }           
+                NumberUtils::appendInteger(con, elem.Int());
+                break;
             case bsonTimestamp:
                 {
                     Date_t date = elem.timestampTime();
@@ -709,12 +953,8 @@ namespace Robomongo
                     break;
                 }
             case NumberLong:
-                {
-                    char num[32] = {0};
-                    sprintf(num, "%lld", elem.Long());
-                    con.append(num);
-                    break; 
-                }
+                NumberUtils::appendInteger(con, elem.Long());
+                break;
 			case NumberDecimal:
 			{
 				con.append(elem.numberDecimal().toString());
@@ -750,5 +990,16 @@ namespace Robomongo
             return i;
         }
 
+        const char *const truncatedMarker = "__truncated";
+
+        bool isTruncated(const mongo::BSONElement &elem)
+        {
+            if (elem.type() != mongo::Object)
+                return false;
+
+            mongo::BSONObj obj = elem.Obj();
+            return obj.nFields() == 2 && strcmp(obj.firstElementFieldName(), truncatedMarker) == 0;
+        }
+
     } // BsonUtils
 } // Robomongo
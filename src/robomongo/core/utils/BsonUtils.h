@@ -82,12 +82,61 @@ namespace Robomongo
             return bsonelement_cast<typename detail::bson_convert_traits<BSONType_t>::type>(elem);
         }
 
-        std::string jsonString(const mongo::BSONObj &obj, mongo::JsonStringFormat format, int pretty,
+        /**
+         * @brief Formats of writeJson():
+         * TenGenJson - mongo shell syntax (ObjectId(...), ISODate(...), NumberLong(...)), as mongo::TenGen;
+         * StrictJson - legacy MongoDB Extended JSON, valid JSON with shell types wrapped ($oid, $date, ...);
+         * RelaxedJson - Relaxed Extended JSON (MongoDB Extended JSON v2): numbers are plain JSON numbers,
+         * dates are ISO-8601 strings in UTC, other types are wrapped as the v2 specification defines.
+         */
+        enum JsonFormat
+        {
+            TenGenJson  = 0,
+            StrictJson  = 1,
+            RelaxedJson = 2
+        };
+
+        std::string jsonString(const mongo::BSONObj &obj, JsonFormat format, int pretty,
+            UUIDEncoding uuidEncoding, SupportedTimes timeFormat, bool isArray = false);
+
+        std::string jsonString(const mongo::BSONElement &elem, JsonFormat format, bool includeFieldNames, int pretty,
+            UUIDEncoding uuidEncoding, SupportedTimes timeFormat, bool isArray = false);
+
+        /**
+         * @brief Appends JSON of document (or element) to the end of 'out'. Nested values
+         * are written into the same buffer, no intermediate strings are built. Callers that
+         * stream text (to file, socket, view) can drain 'out' between documents.
+         */
+        void writeJson(std::string &out, const mongo::BSONObj &obj, JsonFormat format, int pretty,
             UUIDEncoding uuidEncoding, SupportedTimes timeFormat, bool isArray = false);
 
-        std::string jsonString(const mongo::BSONElement &elem, mongo::JsonStringFormat format, bool includeFieldNames, int pretty,
+        void writeJson(std::string &out, const mongo::BSONElement &elem, JsonFormat format, bool includeFieldNames,
+            int pretty, UUIDEncoding uuidEncoding, SupportedTimes timeFormat, bool isArray = false);
+
+        /**
+         * @brief Destination of writeJson() other than std::string. Text is passed in chunks
+         * while document is written, so large documents are not held in memory as a whole.
+         */
+        class JsonSink
+        {
+        public:
+            virtual ~JsonSink() {}
+            virtual void append(const char *data, size_t size) = 0;
+        };
+
+        void writeJson(JsonSink &sink, const mongo::BSONObj &obj, JsonFormat format, int pretty,
             UUIDEncoding uuidEncoding, SupportedTimes timeFormat, bool isArray = false);
 
+        void writeJson(JsonSink &sink, const mongo::BSONElement &elem, JsonFormat format, bool includeFieldNames,
+            int pretty, UUIDEncoding uuidEncoding, SupportedTimes timeFormat, bool isArray = false);
+
+        /**
+         * @brief Number of line breaks in pretty JSON of document (written by writeJson()
+         * with pretty > 0), counted from BSON structure without formatting.
+         */
+        int jsonLineBreaks(const mongo::BSONObj &obj);
+        int jsonLineBreaks(const mongo::BSONElement &elem);
+
         bool isArray(const mongo::BSONElement &elem);
         bool isArray(mongo::BSONType type);
         bool isDocument(const mongo::BSONElement &elem);
@@ -105,6 +154,13 @@ namespace Robomongo
 
         mongo::BSONElement indexOf(const mongo::BSONObj &doc, int index);
         int elementsCount(const mongo::BSONObj &doc);
+
+        /**
+         * @brief Values truncated on server are replaced with
+         * { __truncated: <length of original value>, value: <beginning of value> }
+         */
+        extern const char *const truncatedMarker;
+        bool isTruncated(const mongo::BSONElement &elem);
     }
 }
 
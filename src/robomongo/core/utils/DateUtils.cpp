@@ -0,0 +1,160 @@
+#include "robomongo/core/utils/DateUtils.h"
+
+#include <atomic>
+#include <ctime>
+
+namespace
+{
+    const long long msPerMinute = 60 * 1000;
+    const long long msPerDay = 24 * 60 * msPerMinute;
+    const long long secondsPerHour = 60 * 60;
+
+    /**
+     * @brief Direct-mapped cache of local UTC offsets: hour since epoch in high
+     * bits, offset in minutes + emptyOffset in low 16 bits, 0 when slot is empty
+     */
+    enum { offsetCacheSize = 16 * 1024 };  // hours, about two years of dates
+    enum { emptyOffset = 0x8000 };
+    std::atomic<unsigned long long> offsetCache[offsetCacheSize];
+
+    long long floorDiv(long long a, long long b)
+    {
+        const long long q = a / b;
+        return a % b < 0 ? q - 1 : q;
+    }
+
+    // Calendar conversions after "chrono-Compatible Low-Level Date Algorithms"
+    // (Howard Hinnant), proleptic Gregorian calendar
+
+    long long daysFromCivil(long long year, int month, int day)
+    {
+        year -= month <= 2;
+        const long long era = floorDiv(year, 400);
+        const long long yearOfEra = year - era * 400;
+        const long long dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+        const long long dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+        return era * 146097 + dayOfEra - 719468;
+    }
+
+    void civilFromDays(long long days, int &year, int &month, int &day)
+    {
+        days += 719468;
+        const long long era = floorDiv(days, 146097);
+        const int dayOfEra = static_cast<int>(days - era * 146097);
+        const int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+        const int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+        const int monthFromMarch = (5 * dayOfYear + 2) / 153;
+        day = dayOfYear - (153 * monthFromMarch + 2) / 5 + 1;
+        month = monthFromMarch < 10 ? monthFromMarch + 3 : monthFromMarch - 9;
+        year = static_cast<int>(yearOfEra + era * 400) + (month <= 2);
+    }
+
+    /**
+     * @brief Offset computed by C library, false when moment is out of its range
+     */
+    bool systemUtcOffset(long long seconds, int &offset)
+    {
+        const time_t time = static_cast<time_t>(seconds);
+        if (time != seconds)
+            return false;
+
+        struct tm local;
+#ifdef _WIN32
+        if (localtime_s(&local, &time) != 0)
+            return false;
+#else
+        if (!localtime_r(&time, &local))
+            return false;
+#endif
+
+        const long long localSeconds = daysFromCivil(local.tm_year + 1900LL, local.tm_mon + 1, local.tm_mday) * 86400
+                                       + local.tm_hour * 3600 + local.tm_min * 60 + local.tm_sec;
+        offset = static_cast<int>(floorDiv(localSeconds - seconds, 60));
+        return true;
+    }
+
+    char *write2(char *dest, int value)
+    {
+        dest[0] = static_cast<char>('0' + value / 10);
+        dest[1] = static_cast<char>('0' + value % 10);
+        return dest + 2;
+    }
+}
+
+namespace Robomongo
+{
+    namespace DateUtils
+    {
+        char *formatIsoDate(char *dest, long long ms, bool useTseparator, bool isLocalTime)
+        {
+            const int offset = isLocalTime ? localUtcOffset(ms) : 0;
+            const long long time = ms + offset * msPerMinute;
+            const long long days = floorDiv(time, msPerDay);
+            const int msOfDay = static_cast<int>(time - days * msPerDay);
+            const int secondsOfDay = msOfDay / 1000;
+
+            int year, month, day;
+            civilFromDays(days, year, month, day);
+
+            dest = write2(dest, year / 100);
+            dest = write2(dest, year % 100);
+            *dest++ = '-';
+            dest = write2(dest, month);
+            *dest++ = '-';
+            dest = write2(dest, day);
+            *dest++ = useTseparator ? 'T' : ' ';
+            dest = write2(dest, secondsOfDay / 3600);
+            *dest++ = ':';
+            dest = write2(dest, secondsOfDay / 60 % 60);
+            *dest++ = ':';
+            dest = write2(dest, secondsOfDay % 60);
+            *dest++ = '.';
+            *dest++ = static_cast<char>('0' + msOfDay % 1000 / 100);
+            dest = write2(dest, msOfDay % 100);
+
+            if (!isLocalTime) {
+                *dest++ = 'Z';
+                return dest;
+            }
+
+            const int absOffset = offset < 0 ? -offset : offset;
+            *dest++ = offset < 0 ? '-' : '+';
+            dest = write2(dest, absOffset / 60);
+            *dest++ = ':';
+            return write2(dest, absOffset % 60);
+        }
+
+        void appendIsoDate(std::string &out, long long ms, bool useTseparator, bool isLocalTime)
+        {
+            char buffer[maxIsoDateLength];
+            out.append(buffer, formatIsoDate(buffer, ms, useTseparator, isLocalTime));
+        }
+
+        int localUtcOffset(long long ms)
+        {
+            const long long hour = floorDiv(ms, secondsPerHour * 1000);
+            const unsigned long long key = static_cast<unsigned long long>(hour) << 16;
+            std::atomic<unsigned long long> &slot = offsetCache[hour & (offsetCacheSize - 1)];
+
+            const unsigned long long entry = slot.load(std::memory_order_relaxed);
+            if ((entry & 0xFFFF) != 0 && (entry & ~0xFFFFULL) == key)
+                return static_cast<int>(entry & 0xFFFF) - emptyOffset;
+
+            // Offset is cached when it is the same at start and end of hour. Hours with
+            // transitions (possible in zones with offsets like +05:30) are not cached.
+            int first = 0;
+            int last = 0;
+            if (systemUtcOffset(hour * secondsPerHour, first) && systemUtcOffset(hour * secondsPerHour + secondsPerHour - 1, last)
+                && first == last) {
+                slot.store(key | static_cast<unsigned long long>(first + emptyOffset), std::memory_order_relaxed);
+                return first;
+            }
+
+            // Moments out of range of C library get current offset
+            int offset = 0;
+            if (!systemUtcOffset(floorDiv(ms, 1000), offset))
+                systemUtcOffset(time(NULL), offset);
+            return offset;
+        }
+    }
+}
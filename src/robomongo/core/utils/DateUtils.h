@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+
+namespace Robomongo
+{
+    /**
+     * @brief Formatting of BSON dates for JSON output, written straight into caller's buffer.
+     * Calendar date is computed from days since epoch without C library or boost calls,
+     * local UTC offsets are cached per hour.
+     */
+    namespace DateUtils
+    {
+        enum { maxIsoDateLength = 32 };  // enough for any supported date
+
+        /**
+         * @brief ISO-8601 text of 'ms' milliseconds since epoch: 2016-01-31T12:00:00.000Z,
+         * or local time with UTC offset of that moment (2016-01-31T14:00:00.000+02:00)
+         * when 'isLocalTime'. Same as miutil::isotimeString(). Year must be in 0..9999.
+         * @return end of written text, not null-terminated
+         */
+        char *formatIsoDate(char *dest, long long ms, bool useTseparator, bool isLocalTime);
+
+        void appendIsoDate(std::string &out, long long ms, bool useTseparator, bool isLocalTime);
+
+        /**
+         * @brief Offset of local time zone from UTC, in minutes, at moment 'ms'
+         */
+        int localUtcOffset(long long ms);
+    }
+}
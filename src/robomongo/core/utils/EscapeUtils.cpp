@@ -0,0 +1,280 @@
+#include "robomongo/core/utils/EscapeUtils.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define ROBOMONGO_X86
+    #include <immintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #endif
+#endif
+
+#if defined(ROBOMONGO_X86) && (defined(__GNUC__) || defined(__clang__))
+    #define ROBOMONGO_TARGET(isa) __attribute__((target(isa)))
+#else
+    #define ROBOMONGO_TARGET(isa)
+#endif
+
+namespace
+{
+    using namespace Robomongo::EscapeUtils;
+
+    const char hexDigits[] = "0123456789abcdef";
+    const char replacementCharacter[] = "\xEF\xBF\xBD"; // U+FFFD in UTF-8
+
+    typedef size_t (*FindFunction)(const char *data, size_t length, bool escapeSlash);
+
+    inline bool isSpecial(unsigned char ch, bool escapeSlash)
+    {
+        // Non-ASCII bytes are special too: they are validated as UTF-8
+        return ch < 0x20 || ch >= 0x80 || ch == '"' || ch == '\\' || (ch == '/' && escapeSlash);
+    }
+
+    /**
+     * @brief Position of first byte that is not copied as is, 'length' if there is no such byte
+     */
+    size_t findSpecialScalar(const char *data, size_t length, bool escapeSlash)
+    {
+        for (size_t i = 0; i < length; ++i) {
+            if (isSpecial(data[i], escapeSlash))
+                return i;
+        }
+        return length;
+    }
+
+#ifdef ROBOMONGO_X86
+    inline int firstBit(unsigned int mask)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return index;
+#else
+        return __builtin_ctz(mask);
+#endif
+    }
+
+    ROBOMONGO_TARGET("sse2")
+    size_t findSpecialSse2(const char *data, size_t length, bool escapeSlash)
+    {
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i slash = _mm_set1_epi8(escapeSlash ? '/' : '"');
+        const __m128i space = _mm_set1_epi8(0x20);
+
+        size_t i = 0;
+        for (; i + 16 <= length; i += 16) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+
+            // Signed compare: bytes >= 0x80 are negative, so they are less than space too
+            __m128i special = _mm_cmplt_epi8(v, space);
+            special = _mm_or_si128(special, _mm_cmpeq_epi8(v, quote));
+            special = _mm_or_si128(special, _mm_cmpeq_epi8(v, backslash));
+            special = _mm_or_si128(special, _mm_cmpeq_epi8(v, slash));
+
+            const unsigned int mask = _mm_movemask_epi8(special);
+            if (mask)
+                return i + firstBit(mask);
+        }
+
+        return i + findSpecialScalar(data + i, length - i, escapeSlash);
+    }
+
+    ROBOMONGO_TARGET("avx2")
+    size_t findSpecialAvx2(const char *data, size_t length, bool escapeSlash)
+    {
+        const __m256i quote = _mm256_set1_epi8('"');
+        const __m256i backslash = _mm256_set1_epi8('\\');
+        const __m256i slash = _mm256_set1_epi8(escapeSlash ? '/' : '"');
+        const __m256i space = _mm256_set1_epi8(0x20);
+
+        size_t i = 0;
+        for (; i + 32 <= length; i += 32) {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+
+            __m256i special = _mm256_cmpgt_epi8(space, v);
+            special = _mm256_or_si256(special, _mm256_cmpeq_epi8(v, quote));
+            special = _mm256_or_si256(special, _mm256_cmpeq_epi8(v, backslash));
+            special = _mm256_or_si256(special, _mm256_cmpeq_epi8(v, slash));
+
+            const unsigned int mask = _mm256_movemask_epi8(special);
+            if (mask)
+                return i + firstBit(mask);
+        }
+
+        return i + findSpecialSse2(data + i, length - i, escapeSlash);
+    }
+
+    bool hasAvx2()
+    {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7)
+            return false;
+
+        // AVX registers should be saved by OS
+        __cpuid(info, 1);
+        const bool osxsave = (info[2] & (1 << 27)) != 0;
+        if (!osxsave || (_xgetbv(0) & 6) != 6)
+            return false;
+
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+
+    bool hasSse2()
+    {
+#if defined(__x86_64__) || defined(_M_X64)
+        return true;
+#elif defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 1);
+        return (info[3] & (1 << 26)) != 0;
+#else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("sse2");
+#endif
+    }
+#endif
+
+    FindFunction findFunction(Kernel kernel)
+    {
+        switch (kernel) {
+#ifdef ROBOMONGO_X86
+        case Avx2Kernel: return findSpecialAvx2;
+        case Sse2Kernel: return findSpecialSse2;
+#endif
+        default: return findSpecialScalar;
+        }
+    }
+
+    inline bool isContinuation(unsigned char ch)
+    {
+        return (ch & 0xC0) == 0x80;
+    }
+
+    /**
+     * @brief Length of valid UTF-8 sequence that starts with non-ASCII byte,
+     * 0 if sequence is invalid (overlong, surrogate, above U+10FFFF or cut)
+     */
+    size_t utf8SequenceLength(const unsigned char *s, size_t length)
+    {
+        const unsigned char lead = s[0];
+        size_t size;
+        unsigned char min = 0x80, max = 0xBF; // range of second byte
+
+        if (lead >= 0xC2 && lead <= 0xDF) {
+            size = 2;
+        }
+        else if (lead >= 0xE0 && lead <= 0xEF) {
+            size = 3;
+            if (lead == 0xE0) min = 0xA0;
+            if (lead == 0xED) max = 0x9F;
+        }
+        else if (lead >= 0xF0 && lead <= 0xF4) {
+            size = 4;
+            if (lead == 0xF0) min = 0x90;
+            if (lead == 0xF4) max = 0x8F;
+        }
+        else {
+            return 0;
+        }
+
+        if (length < size || s[1] < min || s[1] > max)
+            return 0;
+
+        for (size_t i = 2; i < size; ++i) {
+            if (!isContinuation(s[i]))
+                return 0;
+        }
+        return size;
+    }
+
+    void appendEscapedCharacter(std::string &out, unsigned char ch)
+    {
+        switch (ch) {
+        case '"': out.append("\\\"", 2); break;
+        case '\\': out.append("\\\\", 2); break;
+        case '/': out.append("\\/", 2); break;
+        case '\b': out.append("\\b", 2); break;
+        case '\f': out.append("\\f", 2); break;
+        case '\n': out.append("\\n", 2); break;
+        case '\r': out.append("\\r", 2); break;
+        case '\t': out.append("\\t", 2); break;
+        default:
+            out.append("\\u00", 4);
+            out += hexDigits[ch >> 4];
+            out += hexDigits[ch & 0xF];
+            break;
+        }
+    }
+}
+
+namespace Robomongo
+{
+    namespace EscapeUtils
+    {
+        Kernel supportedKernel()
+        {
+#ifdef ROBOMONGO_X86
+            static const Kernel kernel = hasAvx2() ? Avx2Kernel : (hasSse2() ? Sse2Kernel : ScalarKernel);
+            return kernel;
+#else
+            return ScalarKernel;
+#endif
+        }
+
+        const char *kernelName(Kernel kernel)
+        {
+            switch (kernel) {
+            case Avx2Kernel: return "AVX2";
+            case Sse2Kernel: return "SSE2";
+            default: return "scalar";
+            }
+        }
+
+        void appendEscaped(std::string &out, const char *data, size_t length, bool escapeSlash)
+        {
+            static const Kernel kernel = supportedKernel();
+            appendEscaped(out, data, length, escapeSlash, kernel);
+        }
+
+        void appendEscaped(std::string &out, const char *data, size_t length, bool escapeSlash, Kernel kernel)
+        {
+            const FindFunction findSpecial = findFunction(kernel);
+            const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data);
+
+            // Clean bytes and valid UTF-8 sequences are accumulated in run [start, i)
+            size_t start = 0;
+            size_t i = 0;
+            while (true) {
+                i += findSpecial(data + i, length - i, escapeSlash);
+                if (i == length)
+                    break;
+
+                if (bytes[i] >= 0x80) {
+                    const size_t size = utf8SequenceLength(bytes + i, length - i);
+                    if (size) {
+                        i += size;
+                        continue;
+                    }
+
+                    out.append(data + start, i - start);
+                    out.append(replacementCharacter, 3);
+                }
+                else {
+                    out.append(data + start, i - start);
+                    appendEscapedCharacter(out, bytes[i]);
+                }
+
+                start = ++i;
+            }
+
+            out.append(data + start, length - start);
+        }
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+
+namespace Robomongo
+{
+    /**
+     * @brief Escaping of strings for JSON output. Bytes that need escaping are
+     * searched 16 (SSE2) or 32 (AVX2) at a time, runs of clean bytes are copied
+     * to output at once. Kernel is selected at runtime by CPU features.
+     */
+    namespace EscapeUtils
+    {
+        enum Kernel
+        {
+            ScalarKernel,
+            Sse2Kernel,
+            Avx2Kernel
+        };
+
+        /**
+         * @brief Fastest kernel supported by CPU
+         */
+        Kernel supportedKernel();
+        const char *kernelName(Kernel kernel);
+
+        /**
+         * @brief Appends 'data' to 'out' escaped as JSON string (without quotes).
+         * Quotes, backslashes and control characters are escaped the same way as
+         * mongo::escape() does. Invalid UTF-8 bytes are replaced with U+FFFD.
+         */
+        void appendEscaped(std::string &out, const char *data, size_t length, bool escapeSlash = false);
+        void appendEscaped(std::string &out, const char *data, size_t length, bool escapeSlash, Kernel kernel);
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+
+namespace Robomongo
+{
+    /**
+     * @brief Formatting of numbers for JSON output, written straight into caller's buffer.
+     * Doubles are printed with the shortest digits that parse back to the same value,
+     * integers with table of digit pairs. C locale is always used.
+     */
+    namespace NumberUtils
+    {
+        enum { maxIntegerLength = 24 };  // enough for any long long
+        enum { maxDoubleLength = 32 };   // enough for any double
+
+        /**
+         * @return end of written text, not null-terminated
+         */
+        char *formatInteger(char *dest, long long value);
+
+        /**
+         * @brief Fixed notation for 1e-6 <= |value| < 1e21, exponential otherwise
+         * (same as JavaScript). Integral values get ".0" suffix, so that they are
+         * parsed back as doubles. NaN and infinities are written as NaN, Infinity
+         * and -Infinity.
+         * @return end of written text, not null-terminated
+         */
+        char *formatDouble(char *dest, double value);
+
+        void appendInteger(std::string &out, long long value);
+        void appendDouble(std::string &out, double value);
+    }
+}
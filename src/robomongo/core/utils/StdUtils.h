@@ -2,6 +2,8 @@
 
 #include <algorithm>
 #include <functional>
+#include <thread>
+#include <vector>
 
 namespace Robomongo
 {
@@ -59,5 +61,77 @@ namespace Robomongo
                 delete [] ptr;
             }
         };
+
+        /**
+         * @brief Number of threads for splitting 'count' items into chunks of at least 'minChunk' items
+         */
+        inline size_t parallelThreads(size_t count, size_t minChunk)
+        {
+            size_t threads = std::max(1u, std::thread::hardware_concurrency());
+            return std::max<size_t>(1, std::min(threads, count / std::max<size_t>(1, minChunk)));
+        }
+
+        /**
+         * @brief Calls func(begin, end) for contiguous chunks of [0, count) in parallel threads.
+         * Returns when all chunks are processed.
+         */
+        template<typename Func>
+        void parallelFor(size_t count, size_t minChunk, Func func)
+        {
+            const size_t threads = parallelThreads(count, minChunk);
+            if (threads == 1) {
+                func(0, count);
+                return;
+            }
+
+            std::vector<std::thread> workers;
+            const size_t chunk = (count + threads - 1) / threads;
+            for (size_t begin = 0; begin < count; begin += chunk)
+                workers.push_back(std::thread(func, begin, std::min(count, begin + chunk)));
+
+            for (size_t i = 0; i < workers.size(); ++i)
+                workers[i].join();
+        }
+
+        /**
+         * @brief Sorts [first, last) by sorting chunks in parallel threads
+         * and merging neighbour chunks pairwise, also in parallel.
+         */
+        template<typename RandomIt, typename Compare>
+        void parallelSort(RandomIt first, RandomIt last, Compare comp)
+        {
+            const size_t count = last - first;
+            const size_t threads = parallelThreads(count, 16 * 1024);
+            if (threads == 1) {
+                std::sort(first, last, comp);
+                return;
+            }
+
+            std::vector<size_t> bounds;
+            const size_t chunk = (count + threads - 1) / threads;
+            for (size_t begin = 0; begin < count; begin += chunk)
+                bounds.push_back(begin);
+            bounds.push_back(count);
+
+            parallelFor(bounds.size() - 1, 1, [&](size_t from, size_t till) {
+                for (size_t i = from; i < till; ++i)
+                    std::sort(first + bounds[i], first + bounds[i + 1], comp);
+            });
+
+            while (bounds.size() > 2) {
+                const size_t pairs = (bounds.size() - 1) / 2;
+                parallelFor(pairs, 1, [&](size_t from, size_t till) {
+                    for (size_t i = from; i < till; ++i)
+                        std::inplace_merge(first + bounds[2 * i], first + bounds[2 * i + 1], first + bounds[2 * i + 2], comp);
+                });
+
+                std::vector<size_t> merged;
+                for (size_t i = 0; i < bounds.size(); i += 2)
+                    merged.push_back(bounds[i]);
+                if (merged.back() != count)
+                    merged.push_back(count);
+                bounds.swap(merged);
+            }
+        }
     }
 }
@@ -74,6 +74,12 @@ namespace
         Robomongo::AppRegistry::instance().settingsManager()->save();
     }
     
+    void saveTruncateLongValues(bool isTruncate)
+    {
+        Robomongo::AppRegistry::instance().settingsManager()->setTruncateLongValues(isTruncate);
+        Robomongo::AppRegistry::instance().settingsManager()->save();
+    }
+
     void saveAutoExec(bool isAutoExec)
     {
         Robomongo::AppRegistry::instance().settingsManager()->setAutoExec(isAutoExec);
@@ -414,6 +420,12 @@ namespace Robomongo
         VERIFY(connect(autoExpand, SIGNAL(triggered()), this, SLOT(toggleAutoExpand())));
         optionsMenu->addAction(autoExpand);
 
+        QAction *truncateLongValues = new QAction("Truncate Long Values When Paging", this);
+        truncateLongValues->setCheckable(true);
+        truncateLongValues->setChecked(AppRegistry::instance().settingsManager()->truncateLongValues());
+        VERIFY(connect(truncateLongValues, SIGNAL(triggered()), this, SLOT(toggleTruncateLongValues())));
+        optionsMenu->addAction(truncateLongValues);
+
         QAction *showLineNumbers = new QAction("Show Line Numbers By Default", this);
         showLineNumbers->setCheckable(true);
         showLineNumbers->setChecked(AppRegistry::instance().settingsManager()->lineNumbers());
@@ -942,6 +954,12 @@ namespace Robomongo
         saveAutoExpand(send->isChecked());
     }
     
+    void MainWindow::toggleTruncateLongValues()
+    {
+        QAction *send = qobject_cast<QAction*>(sender());
+        saveTruncateLongValues(send->isChecked());
+    }
+
     void MainWindow::toggleAutoExec()
     {
         QAction *send = qobject_cast<QAction*>(sender());
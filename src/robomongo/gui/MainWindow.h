@@ -46,6 +46,7 @@ namespace Robomongo
         void enterTableMode();
         void enterCustomMode();
         void toggleAutoExpand();
+        void toggleTruncateLongValues();
         void toggleAutoExec();
         void toggleLineNumbers();
         void executeScript();
@@ -0,0 +1,187 @@
+#include "robomongo/gui/editors/JsonLexer.h"
+
+#include <cstring>
+#include <vector>
+#include <Qsci/qsciscintilla.h>
+
+namespace
+{
+    using namespace Robomongo;
+
+    // Short names of classes and states, so that tables below fit on screen
+    enum
+    {
+        O = JsonLexer::ClassOther,
+        S = JsonLexer::ClassSpace,
+        N = JsonLexer::ClassNewline,
+        Q = JsonLexer::ClassQuote,
+        B = JsonLexer::ClassBackslash,
+        L = JsonLexer::ClassSlash,
+        T = JsonLexer::ClassStar,
+        D = JsonLexer::ClassDigit,
+        G = JsonLexer::ClassSign,
+        P = JsonLexer::ClassDot,
+        A = JsonLexer::ClassLetter,
+        R = JsonLexer::ClassOperator
+    };
+
+    enum
+    {
+        Df = JsonLexer::StateDefault,
+        Op = JsonLexer::StateOperator,
+        St = JsonLexer::StateString,
+        Es = JsonLexer::StateEscape,
+        Se = JsonLexer::StateStringEnd,
+        Nu = JsonLexer::StateNumber,
+        Wo = JsonLexer::StateWord,
+        Sl = JsonLexer::StateSlash,
+        Co = JsonLexer::StateComment,
+        Cs = JsonLexer::StateCommentStar,
+        Ce = JsonLexer::StateCommentEnd,
+        Lc = JsonLexer::StateLineComment
+    };
+
+    /**
+     * @brief Wrappers of values written by BsonUtils::writeJson(), literals
+     * and common words of JavaScript code
+     */
+    const char *const keywords[] = {
+        "BinData", "CSUUID", "DBRef", "Date", "ISODate", "JUUID", "LUUID", "MaxKey", "MinKey",
+        "NUUID", "NumberDecimal", "NumberInt", "NumberLong", "ObjectId", "PYUUID", "Timestamp", "UUID",
+        "false", "function", "null", "return", "this", "true", "undefined", "var"
+    };
+}
+
+namespace Robomongo
+{
+    const unsigned char JsonLexer::_classes[128] = {
+        O, O, O, O, O, O, O, O, O, S, N, S, S, S, O, O,
+        O, O, O, O, O, O, O, O, O, O, O, O, O, O, O, O,
+        S, O, Q, O, A, O, O, O, R, R, T, G, R, G, P, L,
+        D, D, D, D, D, D, D, D, D, D, R, O, O, O, O, O,
+        O, A, A, A, A, A, A, A, A, A, A, A, A, A, A, A,
+        A, A, A, A, A, A, A, A, A, A, A, R, B, R, O, A,
+        O, A, A, A, A, A, A, A, A, A, A, A, A, A, A, A,
+        A, A, A, A, A, A, A, A, A, A, A, R, O, R, O, O
+    };
+
+    // Next state by current state and class of character:
+    //   O   S   N   Q   B   L   T   D   G   P   A   R
+    const unsigned char JsonLexer::_transitions[StateCount][ClassCount] = {
+        { Df, Df, Df, St, Df, Sl, Op, Nu, Nu, Op, Wo, Op },   // Default
+        { Df, Df, Df, St, Df, Sl, Op, Nu, Nu, Op, Wo, Op },   // Operator
+        { St, St, Df, Se, Es, St, St, St, St, St, St, St },   // String
+        { St, St, Df, St, St, St, St, St, St, St, St, St },   // Escape
+        { Df, Df, Df, St, Df, Sl, Op, Nu, Nu, Op, Wo, Op },   // StringEnd
+        { Df, Df, Df, St, Df, Sl, Op, Nu, Nu, Nu, Nu, Op },   // Number
+        { Df, Df, Df, St, Df, Sl, Op, Wo, Nu, Op, Wo, Op },   // Word
+        { Df, Df, Df, St, Df, Lc, Co, Nu, Nu, Op, Wo, Op },   // Slash
+        { Co, Co, Co, Co, Co, Co, Cs, Co, Co, Co, Co, Co },   // Comment
+        { Co, Co, Co, Co, Co, Ce, Cs, Co, Co, Co, Co, Co },   // CommentStar
+        { Df, Df, Df, St, Df, Sl, Op, Nu, Nu, Op, Wo, Op },   // CommentEnd
+        { Lc, Lc, Df, Lc, Lc, Lc, Lc, Lc, Lc, Lc, Lc, Lc }    // LineComment
+    };
+
+    const unsigned char JsonLexer::_styles[StateCount] = {
+        Default, Operator, String, String, String, Number, Default, Operator, Comment, Comment, Comment, Comment
+    };
+
+    JsonLexer::JsonLexer(QObject *parent) : BaseClass(parent)
+    {
+    }
+
+    const char *JsonLexer::language() const
+    {
+        return "JSON";
+    }
+
+    QString JsonLexer::description(int style) const
+    {
+        switch (style)
+        {
+        case Default:  return "Default";
+        case Comment:  return "Comment";
+        case Number:   return "Number";
+        case Keyword:  return "Keyword";
+        case String:   return "String";
+        case Key:      return "Key";
+        case Operator: return "Operator";
+        }
+
+        return QString();
+    }
+
+    QColor JsonLexer::defaultColor(int style) const
+    {
+        switch (style)
+        {
+        case Comment:  return QColor("#999999");
+        case Number:   return QColor("#FFA09E");
+        case Keyword:  return QColor("#BEE5FF");
+        case String:
+        case Key:      return QColor("#C6F079");
+        case Operator: return QColor("#FFD14D");
+        }
+
+        return QColor("#FFFFFF");
+    }
+
+    QColor JsonLexer::defaultPaper(int style) const
+    {
+        return QColor(73, 76, 78);
+    }
+
+    void JsonLexer::styleText(int start, int end)
+    {
+        QsciScintilla *scintilla = editor();
+        if (!scintilla || start >= end)
+            return;
+
+        // Styling starts at beginning of line, in state saved at end of previous line
+        int line = scintilla->SendScintilla(QsciScintilla::SCI_LINEFROMPOSITION, start);
+        start = scintilla->SendScintilla(QsciScintilla::SCI_POSITIONFROMLINE, line);
+        int state = line > 0 ? scintilla->SendScintilla(QsciScintilla::SCI_GETLINESTATE, line - 1) : StateDefault;
+        if (state < 0 || state >= StateCount)
+            state = StateDefault;
+
+        const int length = end - start;
+        std::vector<char> text(length + 1);
+        scintilla->SendScintilla(QsciScintilla::SCI_GETTEXTRANGE, static_cast<long>(start), static_cast<long>(end), &text[0]);
+
+        std::vector<unsigned char> styles(length);
+        for (int lineStart = 0; lineStart < length; ++line) {
+            const char *newline = static_cast<const char *>(memchr(&text[lineStart], '\n', length - lineStart));
+            const int lineEnd = newline ? newline - &text[0] + 1 : length;
+            state = scan(&text[lineStart], lineEnd - lineStart, state, &styles[lineStart]);
+
+            // State of unfinished last line is not saved, line is styled again from its beginning
+            if (newline)
+                scintilla->SendScintilla(QsciScintilla::SCI_SETLINESTATE, line, state);
+            lineStart = lineEnd;
+        }
+
+        // Runs of characters with the same style are set at once
+        startStyling(start);
+        for (int i = 0; i < length;) {
+            int next = i + 1;
+            while (next < length && styles[next] == styles[i])
+                ++next;
+            setStyling(next - i, styles[i]);
+            i = next;
+        }
+    }
+
+    int JsonLexer::wordStyle(const char *word, int length)
+    {
+        if ((length == 3 && memcmp(word, "NaN", 3) == 0) || (length == 8 && memcmp(word, "Infinity", 8) == 0))
+            return Number;
+
+        for (size_t i = 0; i < sizeof(keywords) / sizeof(keywords[0]); ++i) {
+            const char *keyword = keywords[i];
+            if (keyword[0] == word[0] && strncmp(keyword, word, length) == 0 && keyword[length] == '\0')
+                return Keyword;
+        }
+
+        return Default;
+    }
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <QChar>
+#include <QColor>
+#include <Qsci/qscilexercustom.h>
+
+namespace Robomongo
+{
+    /**
+     * @brief Lexer of JSON and extended JSON (ObjectId(...), ISODate(...), comments
+     * with number of document) for read-only output. Only range that Scintilla asks
+     * for is styled, lines are styled by table-driven state machine which resumes
+     * from state saved at end of previous line. Colors are the same as of JSLexer.
+     */
+    class JsonLexer : public QsciLexerCustom
+    {
+        Q_OBJECT
+
+    public:
+        typedef QsciLexerCustom BaseClass;
+
+        enum Style
+        {
+            Default = 0,
+            Comment,
+            Number,
+            Keyword,        // wrappers of values, true, false, null
+            String,
+            Key,            // string followed by colon
+            Operator
+        };
+
+        enum State
+        {
+            StateDefault = 0,
+            StateOperator,
+            StateString,
+            StateEscape,
+            StateStringEnd,
+            StateNumber,
+            StateWord,
+            StateSlash,
+            StateComment,
+            StateCommentStar,
+            StateCommentEnd,
+            StateLineComment,
+            StateCount
+        };
+
+        enum CharClass
+        {
+            ClassOther = 0,
+            ClassSpace,
+            ClassNewline,
+            ClassQuote,
+            ClassBackslash,
+            ClassSlash,
+            ClassStar,
+            ClassDigit,
+            ClassSign,
+            ClassDot,
+            ClassLetter,
+            ClassOperator,
+            ClassCount
+        };
+
+        explicit JsonLexer(QObject *parent = NULL);
+
+        virtual const char *language() const;
+        virtual QString description(int style) const;
+        virtual QColor defaultColor(int style) const;
+        virtual QColor defaultPaper(int style) const;
+        virtual void styleText(int start, int end);
+
+        /**
+         * @brief Styles one line (or part of it) of 'length' characters, starting in 'state'
+         * saved at end of previous line. Style of every character is written to 'styles'.
+         * @return state at the end of text
+         */
+        template <typename Char>
+        static int scan(const Char *text, int length, int state, unsigned char *styles);
+
+    private:
+        static int charClass(char c) { return static_cast<unsigned char>(c) < 128 ? _classes[static_cast<unsigned char>(c)] : ClassOther; }
+        static int charClass(QChar c) { return c.unicode() < 128 ? _classes[c.unicode()] : ClassOther; }
+        static char latin1(char c) { return c; }
+        static char latin1(QChar c) { return c.toLatin1(); }
+
+        /**
+         * @brief Style of word: Keyword, Number (NaN and Infinity) or Default
+         */
+        static int wordStyle(const char *word, int length);
+
+        template <typename Char>
+        static void styleWord(const Char *text, int begin, int end, unsigned char *styles);
+
+        static const unsigned char _classes[128];
+        static const unsigned char _transitions[StateCount][ClassCount];
+        static const unsigned char _styles[StateCount];
+    };
+
+    template <typename Char>
+    int JsonLexer::scan(const Char *text, int length, int state, unsigned char *styles)
+    {
+        int tokenStart = 0;
+        for (int i = 0; i < length; ++i) {
+            const int previous = state;
+            state = _transitions[state][charClass(text[i])];
+            styles[i] = _styles[state];
+
+            if (state == previous)
+                continue;
+
+            // Fixups at token boundaries, everything else comes from tables
+            if (previous == StateWord) {
+                styleWord(text, tokenStart, i, styles);
+            }
+            else if (previous == StateSlash && (state == StateComment || state == StateLineComment)) {
+                styles[i - 1] = Comment;
+            }
+            else if (state == StateStringEnd) {
+                // Key when next character after spaces is colon
+                int next = i + 1;
+                while (next < length && charClass(text[next]) == ClassSpace)
+                    ++next;
+                if (next < length && text[next] == ':') {
+                    for (int j = tokenStart; j <= i; ++j)
+                        styles[j] = Key;
+                }
+            }
+
+            if (state != StateEscape && !(previous == StateEscape && state == StateString))
+                tokenStart = i;
+        }
+
+        if (state == StateWord)
+            styleWord(text, tokenStart, length, styles);
+
+        return state;
+    }
+
+    template <typename Char>
+    void JsonLexer::styleWord(const Char *text, int begin, int end, unsigned char *styles)
+    {
+        // Longer words are never keywords
+        char word[16];
+        if (end - begin > static_cast<int>(sizeof(word)))
+            return;
+
+        for (int i = begin; i < end; ++i)
+            word[i - begin] = latin1(text[i]);
+
+        const int style = wordStyle(word, end - begin);
+        for (int i = begin; i < end; ++i)
+            styles[i] = style;
+    }
+}
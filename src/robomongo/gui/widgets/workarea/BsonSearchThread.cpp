@@ -0,0 +1,149 @@
+#include "robomongo/gui/widgets/workarea/BsonSearchThread.h"
+
+#include <algorithm>
+#include <QRegularExpression>
+#include <mongo/client/dbclientinterface.h>
+
+#include "robomongo/core/utils/BsonUtils.h"
+#include "robomongo/core/utils/QtUtils.h"
+#include "robomongo/core/utils/StdUtils.h"
+
+namespace
+{
+    using namespace Robomongo;
+
+    const size_t minChunk = 16; // documents scanned by one thread at least
+
+    /**
+     * @brief Matches keys and values of one document. QRegularExpression is not
+     * thread-safe, so every thread has its own matcher.
+     */
+    class DocumentMatcher
+    {
+    public:
+        DocumentMatcher(const QString &pattern, bool isRegex, UUIDEncoding uuidEncoding, SupportedTimes timeZone) :
+            _pattern(pattern),
+            _isRegex(isRegex),
+            _regex(pattern, QRegularExpression::CaseInsensitiveOption),
+            _uuidEncoding(uuidEncoding),
+            _timeZone(timeZone)
+        {
+        }
+
+        void match(const mongo::BSONObj &obj, bool isArray, BsonPath &path, std::vector<BsonPath> &matches) const
+        {
+            int row = 0;
+            mongo::BSONObjIterator iterator(obj);
+            while (iterator.more()) {
+                mongo::BSONElement element = iterator.next();
+                path.push_back(row++);
+
+                // Keys of array elements are their positions, they are not searched
+                bool found = !isArray && isMatch(QtUtils::toQString(element.fieldName()));
+
+                if (BsonUtils::isDocument(element.type())) {
+                    if (found)
+                        matches.push_back(path);
+                    match(element.Obj(), BsonUtils::isArray(element.type()), path, matches);
+                }
+                else {
+                    if (!found)
+                        found = isMatch(valueString(element));
+                    if (found)
+                        matches.push_back(path);
+                }
+
+                path.pop_back();
+            }
+        }
+
+    private:
+        QString valueString(const mongo::BSONElement &element) const
+        {
+            // Strings are searched without quotes and escaping
+            if (element.type() == mongo::String)
+                return QtUtils::toQString(element.String());
+
+            std::string result;
+            BsonUtils::buildJsonString(element, result, _uuidEncoding, _timeZone);
+            return QtUtils::toQString(result);
+        }
+
+        bool isMatch(const QString &text) const
+        {
+            if (_isRegex)
+                return _regex.match(text).hasMatch();
+
+            return text.contains(_pattern, Qt::CaseInsensitive);
+        }
+
+        const QString _pattern;
+        const bool _isRegex;
+        const QRegularExpression _regex;
+        const UUIDEncoding _uuidEncoding;
+        const SupportedTimes _timeZone;
+    };
+}
+
+namespace Robomongo
+{
+    BsonSearchThread::BsonSearchThread(const PreparedDocumentsPtr &documents, const QString &pattern, bool isRegex,
+                                       UUIDEncoding uuidEncoding, SupportedTimes timeZone) :
+        _documents(documents),
+        _pattern(pattern),
+        _isRegex(isRegex),
+        _uuidEncoding(uuidEncoding),
+        _timeZone(timeZone),
+        _stop(false)
+    {
+    }
+
+    void BsonSearchThread::stop()
+    {
+        _stop = true;
+    }
+
+    void BsonSearchThread::takeMatches(std::vector<BsonPath> &matches)
+    {
+        QMutexLocker lock(&_matchesMutex);
+        matches.insert(matches.end(), _matches.begin(), _matches.end());
+        _matches.clear();
+    }
+
+    void BsonSearchThread::run()
+    {
+        const std::vector<mongo::BSONObj> &documents = _documents->_documents;
+        size_t found = 0;
+
+        for (size_t first = 0; first < documents.size() && found < maxMatches; first += blockSize) {
+            if (_stop)
+                return;
+
+            const size_t count = std::min<size_t>(blockSize, documents.size() - first);
+            std::vector<std::vector<BsonPath> > blockMatches(count);
+
+            stdutils::parallelFor(count, minChunk, [&](size_t begin, size_t end) {
+                DocumentMatcher matcher(_pattern, _isRegex, _uuidEncoding, _timeZone);
+                BsonPath path;
+                for (size_t i = begin; i < end && !_stop; ++i) {
+                    const mongo::BSONObj &doc = documents[first + i];
+                    path.assign(1, static_cast<int>(first + i));
+                    matcher.match(doc, doc.isArray(), path, blockMatches[i]);
+                }
+            });
+
+            if (_stop)
+                return;
+
+            {
+                QMutexLocker lock(&_matchesMutex);
+                for (size_t i = 0; i < count; ++i) {
+                    _matches.insert(_matches.end(), blockMatches[i].begin(), blockMatches[i].end());
+                    found += blockMatches[i].size();
+                }
+            }
+
+            emit matchesFound();
+        }
+    }
+}
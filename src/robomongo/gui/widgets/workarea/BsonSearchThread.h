@@ -0,0 +1,60 @@
+#pragma once
+
+#include <QThread>
+#include <QMutex>
+#include <QString>
+#include <vector>
+
+#include "robomongo/core/Enums.h"
+#include "robomongo/gui/widgets/workarea/ModelPrepareThread.h"
+
+namespace Robomongo
+{
+    /**
+     * @brief Path to BSON element: index of top-level document followed by
+     * positions of fields on every level (same as rows in BsonTreeModel)
+     */
+    typedef std::vector<int> BsonPath;
+
+    /*
+    ** In this thread we are searching keys and values of prepared documents.
+    ** Documents are scanned in blocks, every block in parallel threads.
+    */
+    class BsonSearchThread : public QThread
+    {
+        Q_OBJECT
+
+    public:
+        enum { blockSize = 1024 };       // documents scanned before matches are reported
+        enum { maxMatches = 100000 };    // search stops when so many matches are found
+
+        BsonSearchThread(const PreparedDocumentsPtr &documents, const QString &pattern, bool isRegex,
+                         UUIDEncoding uuidEncoding, SupportedTimes timeZone);
+        void stop();
+
+        /**
+         * @brief Moves matches found since previous call to 'matches' (in document order)
+         */
+        void takeMatches(std::vector<BsonPath> &matches);
+
+    Q_SIGNALS:
+        /**
+         * @brief Signals when matches of next block are available
+         */
+        void matchesFound();
+
+    protected:
+        virtual void run();
+
+    private:
+        const PreparedDocumentsPtr _documents;
+        const QString _pattern;
+        const bool _isRegex;
+        const UUIDEncoding _uuidEncoding;
+        const SupportedTimes _timeZone;
+
+        QMutex _matchesMutex;
+        std::vector<BsonPath> _matches;
+        volatile bool _stop;
+    };
+}
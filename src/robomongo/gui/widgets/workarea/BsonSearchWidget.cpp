@@ -0,0 +1,205 @@
+#include "robomongo/gui/widgets/workarea/BsonSearchWidget.h"
+
+#include <QHBoxLayout>
+#include <QLineEdit>
+#include <QCheckBox>
+#include <QPushButton>
+#include <QLabel>
+#include <QTimer>
+#include <QKeyEvent>
+#include <QRegularExpression>
+
+#include "robomongo/core/AppRegistry.h"
+#include "robomongo/core/settings/SettingsManager.h"
+#include "robomongo/core/utils/QtUtils.h"
+
+namespace Robomongo
+{
+    BsonSearchWidget::BsonSearchWidget(QWidget *parent) :
+        BaseClass(parent),
+        _findLine(new QLineEdit(this)),
+        _regex(new QCheckBox("Regex", this)),
+        _next(new QPushButton("Next", this)),
+        _prev(new QPushButton("Previous", this)),
+        _status(new QLabel(this)),
+        _searchTimer(new QTimer(this)),
+        _thread(NULL),
+        _current(-1),
+        _isInvalidRegex(false)
+    {
+        _findLine->setPlaceholderText("Search keys and values");
+        _findLine->setClearButtonEnabled(true);
+
+        QHBoxLayout *layout = new QHBoxLayout();
+        layout->setContentsMargins(2, 2, 6, 2);
+        layout->setSpacing(7);
+        layout->addWidget(_findLine, 1);
+        layout->addWidget(_next);
+        layout->addWidget(_prev);
+        layout->addWidget(_regex);
+        layout->addWidget(_status);
+        setLayout(layout);
+
+        // Search is started when user stops typing
+        _searchTimer->setSingleShot(true);
+        _searchTimer->setInterval(searchDelayMs);
+
+        VERIFY(connect(_searchTimer, SIGNAL(timeout()), this, SLOT(startSearch())));
+        VERIFY(connect(_findLine, SIGNAL(textChanged(const QString&)), _searchTimer, SLOT(start())));
+        VERIFY(connect(_regex, SIGNAL(toggled(bool)), this, SLOT(startSearch())));
+        VERIFY(connect(_next, SIGNAL(clicked()), this, SLOT(goToNextMatch())));
+        VERIFY(connect(_prev, SIGNAL(clicked()), this, SLOT(goToPrevMatch())));
+    }
+
+    BsonSearchWidget::~BsonSearchWidget()
+    {
+        stopSearch();
+    }
+
+    void BsonSearchWidget::setDocuments(const PreparedDocumentsPtr &documents)
+    {
+        _documents = documents;
+        startSearch();
+    }
+
+    BsonPath BsonSearchWidget::currentMatch() const
+    {
+        if (_current < 0)
+            return BsonPath();
+
+        return _matches[_current];
+    }
+
+    void BsonSearchWidget::showSearch()
+    {
+        show();
+        _findLine->setFocus();
+        _findLine->selectAll();
+    }
+
+    void BsonSearchWidget::keyPressEvent(QKeyEvent *event)
+    {
+        if (event->key() == Qt::Key_Escape) {
+            hide();
+            emit closed();
+            return event->accept();
+        }
+        else if (event->key() == Qt::Key_Return || event->key() == Qt::Key_Enter) {
+            if (_searchTimer->isActive()) {
+                // Search right away, first match is selected when found
+                _searchTimer->stop();
+                startSearch();
+            }
+            else if (event->modifiers() & Qt::ShiftModifier) {
+                goToPrevMatch();
+            }
+            else {
+                goToNextMatch();
+            }
+            return event->accept();
+        }
+
+        return BaseClass::keyPressEvent(event);
+    }
+
+    void BsonSearchWidget::stopSearch()
+    {
+        // Thread deletes itself when finished
+        if (_thread) {
+            _thread->stop();
+            _thread = NULL;
+        }
+    }
+
+    void BsonSearchWidget::startSearch()
+    {
+        stopSearch();
+        _matches.clear();
+        _current = -1;
+        _isInvalidRegex = false;
+
+        const QString pattern = _findLine->text();
+        const bool isRegex = _regex->isChecked();
+
+        if (isRegex && !QRegularExpression(pattern).isValid())
+            _isInvalidRegex = true;
+
+        if (_documents && !pattern.isEmpty() && !_isInvalidRegex) {
+            _thread = new BsonSearchThread(_documents, pattern, isRegex,
+                                           AppRegistry::instance().settingsManager()->uuidEncoding(),
+                                           AppRegistry::instance().settingsManager()->timeZone());
+            VERIFY(connect(_thread, SIGNAL(matchesFound()), this, SLOT(matchesFound())));
+            VERIFY(connect(_thread, SIGNAL(finished()), this, SLOT(searchFinished())));
+            VERIFY(connect(_thread, SIGNAL(finished()), _thread, SLOT(deleteLater())));
+            _thread->start();
+        }
+
+        updateStatus();
+    }
+
+    void BsonSearchWidget::matchesFound()
+    {
+        // Matches of previous searches are ignored
+        if (sender() != _thread)
+            return;
+
+        _thread->takeMatches(_matches);
+
+        // First match is selected as soon as it is found
+        if (_current < 0 && !_matches.empty())
+            selectMatch(0);
+        else
+            updateStatus();
+    }
+
+    void BsonSearchWidget::searchFinished()
+    {
+        if (sender() != _thread)
+            return;
+
+        _thread = NULL;
+        updateStatus();
+    }
+
+    void BsonSearchWidget::goToNextMatch()
+    {
+        if (!_matches.empty())
+            selectMatch((_current + 1) % _matches.size());
+    }
+
+    void BsonSearchWidget::goToPrevMatch()
+    {
+        if (!_matches.empty())
+            selectMatch(_current > 0 ? _current - 1 : _matches.size() - 1);
+    }
+
+    void BsonSearchWidget::selectMatch(int index)
+    {
+        _current = index;
+        updateStatus();
+        emit matchSelected();
+    }
+
+    void BsonSearchWidget::updateStatus()
+    {
+        QString status;
+        if (_isInvalidRegex) {
+            status = "Invalid regular expression";
+        }
+        else if (!_findLine->text().isEmpty()) {
+            // Total is not final while search is running
+            QString total = QString::number(_matches.size());
+            if (_thread)
+                total += "+";
+
+            if (_matches.empty() && !_thread)
+                status = "No matches";
+            else
+                status = QString("%1 of %2").arg(_current + 1).arg(total);
+        }
+
+        _status->setText(status);
+        _next->setEnabled(!_matches.empty());
+        _prev->setEnabled(!_matches.empty());
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <QFrame>
+
+#include "robomongo/gui/widgets/workarea/BsonSearchThread.h"
+
+QT_BEGIN_NAMESPACE
+class QLineEdit;
+class QCheckBox;
+class QPushButton;
+class QLabel;
+class QTimer;
+QT_END_NAMESPACE
+
+namespace Robomongo
+{
+    /**
+     * @brief Search bar of tree and table views. Keys and values of all documents
+     * are searched by BsonSearchThread, matches are shown as soon as they are found.
+     */
+    class BsonSearchWidget : public QFrame
+    {
+        Q_OBJECT
+
+    public:
+        typedef QFrame BaseClass;
+        enum { searchDelayMs = 300 };
+
+        explicit BsonSearchWidget(QWidget *parent = NULL);
+        ~BsonSearchWidget();
+
+        /**
+         * @brief Documents to search in. Current search is restarted.
+         */
+        void setDocuments(const PreparedDocumentsPtr &documents);
+
+        /**
+         * @brief Path of current match, empty when there is no current match
+         */
+        BsonPath currentMatch() const;
+
+        void showSearch();
+
+    Q_SIGNALS:
+        /**
+         * @brief Signals when user moves to another match
+         */
+        void matchSelected();
+        void closed();
+
+    protected:
+        virtual void keyPressEvent(QKeyEvent *event);
+
+    private Q_SLOTS:
+        void startSearch();
+        void matchesFound();
+        void searchFinished();
+        void goToNextMatch();
+        void goToPrevMatch();
+
+    private:
+        void stopSearch();
+        void selectMatch(int index);
+        void updateStatus();
+
+        QLineEdit *_findLine;
+        QCheckBox *_regex;
+        QPushButton *_next;
+        QPushButton *_prev;
+        QLabel *_status;
+        QTimer *_searchTimer;
+
+        PreparedDocumentsPtr _documents;
+        BsonSearchThread *_thread;
+        std::vector<BsonPath> _matches;
+        int _current;
+        bool _isInvalidRegex;
+    };
+}
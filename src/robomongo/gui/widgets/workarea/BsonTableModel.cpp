@@ -1,109 +1,250 @@
 #include "robomongo/gui/widgets/workarea/BsonTableModel.h"
 
+#include <limits>
+#include <list>
+#include <mutex>
 #include <QBrush>
+#include <QCollator>
 #include <QIcon>
+#include <mongo/client/dbclientinterface.h>
 
+#include "robomongo/core/AppRegistry.h"
+#include "robomongo/core/settings/SettingsManager.h"
 #include "robomongo/gui/widgets/workarea/BsonTreeItem.h"
 #include "robomongo/gui/widgets/workarea/BsonTreeModel.h"
+#include "robomongo/core/utils/BsonUtils.h"
 #include "robomongo/core/utils/QtUtils.h"
+#include "robomongo/core/utils/StdUtils.h"
 
-namespace Robomongo
+namespace
 {
-    BsonTableModelProxy::BsonTableModelProxy(QObject *parent) 
-        : BaseClass(parent)
+    using namespace Robomongo;
+
+    const size_t minChunk = 4 * 1024; // rows processed by one thread at least
+
+    mongo::BSONElement fieldAt(const mongo::BSONObj &doc, int index)
     {
-       
+        mongo::BSONObjIterator iterator(doc);
+        for (int i = 0; iterator.more(); ++i) {
+            mongo::BSONElement element = iterator.next();
+            if (i == index)
+                return element;
+        }
+        return mongo::BSONElement();
     }
 
-    int BsonTableModelProxy::rowCount(const QModelIndex &parent) const
+    /**
+     * @brief Typed value of one row in sorted column
+     */
+    struct SortKey
     {
-        int count = sourceModel()->rowCount(parent);
-        return count;
-    }
+        int _row;
+        int _type;                        // canonical BSON type, rows without field go first
+        mongo::BSONElement _element;
+        const QCollatorSortKey *_text;    // for strings and symbols, they share canonical type
+    };
 
-    QModelIndex BsonTableModelProxy::parent( const QModelIndex& index ) const
+    int compareValues(const SortKey &a, const SortKey &b)
     {
-        QModelIndex sourceParent = sourceModel()->parent( mapToSource(index) );
-        return sourceParent;
+        if (a._type != b._type)
+            return a._type < b._type ? -1 : 1;
+
+        if (a._text && b._text)
+            return a._text->compare(*b._text);
+
+        if (a._element.eoo() || b._element.eoo())
+            return 0;
+
+        return a._element.woCompare(b._element, false);
     }
+}
 
-    int BsonTableModelProxy::columnCount(const QModelIndex &parent) const
+namespace Robomongo
+{
+    BsonTableModel::BsonTableModel(const PreparedDocumentsPtr &documents, QObject *parent)
+        : BaseClass(parent),
+        _documents(documents),
+        _layout(documents->_layout),
+        _arena(new BsonTreeArena(documents,
+                                 AppRegistry::instance().settingsManager()->uuidEncoding(),
+                                 AppRegistry::instance().settingsManager()->timeZone())),
+        _formatted(formattedCacheSize),
+        _sortColumn(-1),
+        _sortOrder(Qt::AscendingOrder)
     {
-        return _columns.size();
+        _arena->fetchDocuments(_arena->documentsCount());
+
+        _rows.resize(_arena->documentsCount());
+        for (size_t i = 0; i < _rows.size(); ++i)
+            _rows[i] = i;
     }
 
-    QModelIndex BsonTableModelProxy::mapFromSource( const QModelIndex & sourceIndex ) const
+    BsonTableModel::~BsonTableModel()
     {
-        int row = sourceIndex.row();
-        int col = sourceIndex.column();
 
-        BsonTreeItem *node = QtUtils::item<BsonTreeItem *>(sourceIndex);
-        if (!node || _columns.size() <= col)
-            return QModelIndex();
+    }
 
-        BsonTreeItem *child = node->childByKey(_columns[col]);
+    int BsonTableModel::rowCount(const QModelIndex &parent) const
+    {
+        if (parent.isValid())
+            return 0;
 
-        return createIndex( row, col, child );
+        return _rows.size();
     }
 
-    QModelIndex BsonTableModelProxy::sibling(int row, int column, const QModelIndex &idx) const
+    int BsonTableModel::columnCount(const QModelIndex &parent) const
     {
-        return BaseClass::sibling(row, 0, idx);
+        if (parent.isValid())
+            return 0;
+
+        return _layout._columns.size();
     }
 
-    QModelIndex BsonTableModelProxy::index( int row, int col, const QModelIndex& parent ) const
+    QModelIndex BsonTableModel::index(int row, int column, const QModelIndex &parent) const
     {
-        BsonTreeItem *node = QtUtils::item<BsonTreeItem *>(sourceModel()->index(row, 0, parent));
-        if (!node || _columns.size() <= col)
+        if (!hasIndex(row, column, parent))
             return QModelIndex();
 
-        BsonTreeItem *child = node->childByKey(_columns[col]);
+        return createIndex(row, column, cell(_rows[row], column));
+    }
 
-        return createIndex( row, col, child );
+    void BsonTableModel::sort(int column, Qt::SortOrder order)
+    {
+        if (column >= static_cast<int>(_layout._columns.size()))
+            return;
+
+        _sortColumn = column;
+        _sortOrder = order;
+        updateRows();
     }
 
-    QModelIndex BsonTableModelProxy::mapToSource( const QModelIndex &proxyIndex ) const
+    void BsonTableModel::setFilter(const QString &text)
     {
-        if ( !proxyIndex.isValid() )
-            return QModelIndex();
+        _filter = text;
+        updateRows();
+    }
 
-        Q_ASSERT( proxyIndex.model() == this );
-
-        QModelIndex sourceIndex;
-        BsonTreeItem *child = static_cast<BsonTreeItem *>(proxyIndex.internalPointer());
-        if (child) {
-            QtUtils::HackQModelIndex* hack = reinterpret_cast<QtUtils::HackQModelIndex*>(&sourceIndex);
-            BsonTreeItem *parent = static_cast<BsonTreeItem *>(child->parent());
-            hack->r = proxyIndex.row();
-            hack->c = proxyIndex.column();
-            hack->i = parent;
-            hack->m = sourceModel();
+    int BsonTableModel::rowOfDocument(int document) const
+    {
+        for (size_t i = 0; i < _rows.size(); ++i) {
+            if (_rows[i] == document)
+                return i;
         }
-        return sourceIndex;
+        return -1;
+    }
+
+    int BsonTableModel::columnOfField(int document, int field) const
+    {
+        return _layout.column(document, field);
     }
 
-    void BsonTableModelProxy::setSourceModel( QAbstractItemModel* model )
-    {
-        if (model) {
-            BsonTreeItem *child = QtUtils::item<BsonTreeItem *>(model->index(0, 0));
-            if (child) {
-                _root = qobject_cast<BsonTreeItem *>(child->parent());
-                if (_root) {
-                    int count = _root->childrenCount();
-                    for (int i = 0; i < count; ++i) {
-                        BsonTreeItem *child = _root->child(i);
-                        int countc = child->childrenCount();
-                        for (int j = 0; j < countc; ++j) {
-                            addColumn(child->child(j)->key());
+    void BsonTableModel::updateRows()
+    {
+        const std::vector<mongo::BSONObj> &documents = _documents->_documents;
+        const size_t count = documents.size();
+        std::vector<int> rows;
+
+        if (_filter.isEmpty()) {
+            rows.resize(count);
+            for (size_t i = 0; i < count; ++i)
+                rows[i] = i;
+        }
+        else {
+            const UUIDEncoding uuidEncoding = _arena->uuidEncoding();
+            const SupportedTimes timeZone = _arena->timeZone();
+            const QString filter = _filter;
+            std::vector<char> matched(count, 0);
+
+            stdutils::parallelFor(count, minChunk, [&](size_t begin, size_t end) {
+                for (size_t row = begin; row < end; ++row) {
+                    mongo::BSONObjIterator iterator(documents[row]);
+                    while (iterator.more()) {
+                        std::string value;
+                        BsonUtils::buildJsonString(iterator.next(), value, uuidEncoding, timeZone);
+                        if (QtUtils::toQString(value).contains(filter, Qt::CaseInsensitive)) {
+                            matched[row] = 1;
+                            break;
                         }
                     }
                 }
+            });
+
+            for (size_t i = 0; i < count; ++i) {
+                if (matched[i])
+                    rows.push_back(i);
             }
         }
-        return BaseClass::setSourceModel(model);
+
+        if (_sortColumn >= 0 && !rows.empty()) {
+            std::vector<SortKey> keys(rows.size());
+            std::list<std::vector<QCollatorSortKey> > texts;
+            std::mutex textsMutex;
+
+            stdutils::parallelFor(keys.size(), minChunk, [&](size_t begin, size_t end) {
+                QCollator collator;
+                std::vector<QCollatorSortKey> chunkTexts;
+                std::vector<size_t> textKeys;
+
+                for (size_t i = begin; i < end; ++i) {
+                    SortKey &key = keys[i];
+                    key._row = rows[i];
+                    key._type = std::numeric_limits<int>::min();
+                    key._text = NULL;
+
+                    int index = _layout.field(key._row, _sortColumn);
+                    if (index < 0)
+                        continue;
+
+                    key._element = fieldAt(documents[key._row], index);
+                    key._type = mongo::canonicalizeBSONType(key._element.type());
+                    if (key._element.type() == mongo::String || key._element.type() == mongo::Symbol) {
+                        const std::string text(key._element.valuestr(), key._element.valuestrsize() - 1);
+                        chunkTexts.push_back(collator.sortKey(QtUtils::toQString(text)));
+                        textKeys.push_back(i);
+                    }
+                }
+
+                // Vector is not resized anymore, pointers to its elements are stable
+                for (size_t i = 0; i < textKeys.size(); ++i)
+                    keys[textKeys[i]]._text = &chunkTexts[i];
+
+                std::lock_guard<std::mutex> lock(textsMutex);
+                texts.push_back(std::vector<QCollatorSortKey>());
+                texts.back().swap(chunkTexts);
+            });
+
+            const bool ascending = _sortOrder == Qt::AscendingOrder;
+            stdutils::parallelSort(keys.begin(), keys.end(), [ascending](const SortKey &a, const SortKey &b) {
+                int result = compareValues(a, b);
+                if (result != 0)
+                    return ascending ? result < 0 : result > 0;
+
+                // Stable order for equal values
+                return a._row < b._row;
+            });
+
+            for (size_t i = 0; i < keys.size(); ++i)
+                rows[i] = keys[i]._row;
+        }
+
+        beginResetModel();
+        _rows.swap(rows);
+        endResetModel();
+    }
+
+    BsonTreeItem *BsonTableModel::cell(int row, int column) const
+    {
+        int field = _layout.field(row, column);
+        if (field < 0)
+            return NULL;
+
+        // Fields of document are added to arena when its row is shown for the first time
+        BsonTreeItem *document = _arena->document(row);
+        _arena->populate(document);
+        return document->child(field);
     }
 
-    QVariant BsonTableModelProxy::data(const QModelIndex &index, int role) const
+    QVariant BsonTableModel::data(const QModelIndex &index, int role) const
     {
         QVariant result;
 
@@ -120,12 +261,22 @@ namespace Robomongo
         }
 
         if (role == Qt::DisplayRole || role == Qt::ToolTipRole) {
-            bool isCut = node->type() == mongo::String ||  node->type() == mongo::Code || node->type() == mongo::CodeWScope;  
+            bool isCut = node->type() == mongo::String ||  node->type() == mongo::Code || node->type() == mongo::CodeWScope;
+
+            QString value;
+            if (QString *cached = _formatted.object(node)) {
+                value = *cached;
+            }
+            else {
+                value = node->value();
+                _formatted.insert(node, new QString(value), value.size() + 1);
+            }
+
             if (role == Qt::ToolTipRole) {
-                result = isCut ? node->value() : node->value().left(500); 
+                result = isCut ? value : value.left(500);
             }
             else{
-                result = isCut ? node->value() : node->value().simplified().left(300); 
+                result = isCut ? value : value.simplified().left(300);
             }
         }
         else if (role == Qt::DecorationRole) {
@@ -135,39 +286,16 @@ namespace Robomongo
         return result;
     }
 
-    QVariant BsonTableModelProxy::headerData(int section, Qt::Orientation orientation, int role) const
+    QVariant BsonTableModel::headerData(int section, Qt::Orientation orientation, int role) const
     {
         if (role != Qt::DisplayRole)
             return QVariant();
 
         if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
-            return column(section); 
+            return _layout._columns[section];
         } else {
-            return QString("%1").arg(section + 1);
-        }
-    }
-
-    QString BsonTableModelProxy::column(int col) const
-    {
-        return _columns[col];
-    }
-
-    size_t BsonTableModelProxy::findIndexColumn(const QString &col) const
-    {
-        for (int i = 0; i < _columns.size(); ++i) {
-            if (_columns[i] == col) {
-                return i;
-            }
-        }
-        return _columns.size();
-    }
-
-    size_t BsonTableModelProxy::addColumn(const QString &col)
-    {
-        size_t column = findIndexColumn(col);
-        if (column == _columns.size()) {
-            _columns.push_back(col);
+            // Number of document, regardless of sorting and filtering
+            return QString("%1").arg(_rows[section] + 1);
         }
-        return column;
     }
 }
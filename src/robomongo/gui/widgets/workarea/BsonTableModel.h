@@ -1,39 +1,82 @@
 #pragma once
+#include <memory>
 #include <vector>
 
-#include <QAbstractProxyModel>
+#include <QAbstractTableModel>
+#include <QCache>
+
+#include "robomongo/gui/widgets/workarea/ModelPrepareThread.h"
 
 namespace Robomongo
 {
     class BsonTreeItem;
+    class BsonTreeArena;
 
-    class BsonTableModelProxy : public QAbstractProxyModel
+    /**
+     * @brief Table of documents, one column for every distinct top-level field.
+     * Columns and field positions are computed once by ModelPrepareThread,
+     * after that every cell is accessed directly.
+     *
+     * Rows can be sorted and filtered on client side. Documents are never moved,
+     * model only keeps permutation of document indexes that are shown.
+     */
+    class BsonTableModel : public QAbstractTableModel
     {
         Q_OBJECT
 
     public:
-        typedef QAbstractProxyModel BaseClass;
-        typedef std::vector<QString> ColumnsValuesType;
+        typedef QAbstractTableModel BaseClass;
 
-        explicit BsonTableModelProxy(QObject *parent = 0);
-        QVariant data(const QModelIndex &index, int role) const;
+        explicit BsonTableModel(const PreparedDocumentsPtr &documents, QObject *parent = 0);
+        ~BsonTableModel();
 
+        QVariant data(const QModelIndex &index, int role) const;
         int rowCount(const QModelIndex &parent = QModelIndex()) const;
-        int columnCount(const QModelIndex &parent) const;
-
+        int columnCount(const QModelIndex &parent = QModelIndex()) const;
         QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
-        QModelIndex index( int row, int col, const QModelIndex& index ) const;
-        virtual QModelIndex mapFromSource( const QModelIndex & sourceIndex ) const;
-        virtual QModelIndex mapToSource( const QModelIndex &proxyIndex ) const;
-        virtual void setSourceModel( QAbstractItemModel* model );
-        virtual QModelIndex parent( const QModelIndex& index ) const;
-        virtual QModelIndex sibling(int row, int column, const QModelIndex &idx) const;
+        virtual QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const;
+
+        /**
+         * @brief Sorts rows by typed values of 'column' (in BSON comparison order,
+         * strings are compared with collation of current locale). Negative column
+         * restores original order of documents.
+         */
+        virtual void sort(int column, Qt::SortOrder order = Qt::AscendingOrder);
+
+        /**
+         * @brief Shows only documents that have value containing 'text' (case-insensitive).
+         * Empty text shows all documents.
+         */
+        void setFilter(const QString &text);
+
+        /**
+         * @brief Row that shows document 'document', -1 when it is filtered out
+         */
+        int rowOfDocument(int document) const;
+
+        /**
+         * @brief Column of top-level field 'field' of document 'document', or -1
+         */
+        int columnOfField(int document, int field) const;
+
     private:
-        QString column(int col) const;
-        size_t addColumn(const QString &col);
-        size_t findIndexColumn(const QString &col) const;
+        enum { formattedCacheSize = 4 * 1024 * 1024 }; // in characters
+
+        BsonTreeItem *cell(int row, int column) const;
+
+        /**
+         * @brief Rebuilds _rows according to current filter and sort order
+         */
+        void updateRows();
+
+        const PreparedDocumentsPtr _documents;
+        const BsonTableLayout &_layout;
+        const std::unique_ptr<BsonTreeArena> _arena;
+        mutable QCache<const BsonTreeItem *, QString> _formatted;
 
-        ColumnsValuesType _columns;
-        BsonTreeItem *_root;
+        std::vector<int> _rows; // document index of every shown row
+        int _sortColumn;
+        Qt::SortOrder _sortOrder;
+        QString _filter;
     };
 }
@@ -6,6 +6,7 @@
 #include <QKeyEvent>
 
 #include "robomongo/gui/widgets/workarea/BsonTreeItem.h"
+#include "robomongo/gui/widgets/workarea/BsonTableModel.h"
 #include "robomongo/gui/GuiRegistry.h"
 #include "robomongo/core/utils/QtUtils.h"
 
@@ -23,10 +24,122 @@ namespace Robomongo
         horizontalHeader()->setDefaultAlignment(Qt::AlignLeft);
         setStyleSheet("QTableView { border-left: 1px solid #c7c5c4; border-top: 1px solid #c7c5c4; gridline-color: #edebea;}");
 
+        // Sorting is done by BsonTableModel, original order is shown until header is clicked
+        horizontalHeader()->setSortIndicator(-1, Qt::AscendingOrder);
+        setSortingEnabled(true);
+
         setSelectionMode(QAbstractItemView::ExtendedSelection);
         setSelectionBehavior(QAbstractItemView::SelectItems);
         setContextMenuPolicy(Qt::CustomContextMenu);
         VERIFY(connect(this, SIGNAL(customContextMenuRequested(const QPoint&)), this, SLOT(showContextMenu(const QPoint&))));
+
+        // Columns are chosen in context menu of header
+        horizontalHeader()->setContextMenuPolicy(Qt::CustomContextMenu);
+        VERIFY(connect(horizontalHeader(), SIGNAL(customContextMenuRequested(const QPoint&)), this, SLOT(showHeaderMenu(const QPoint&))));
+    }
+
+    void BsonTableView::setModel(QAbstractItemModel *model)
+    {
+        BaseClass::setModel(model);
+        if (model)
+            VERIFY(connect(model, SIGNAL(modelReset()), this, SLOT(applyHiddenColumns())));
+        applyHiddenColumns();
+    }
+
+    void BsonTableView::setHiddenColumns(const QStringList &columns)
+    {
+        _hiddenColumns = columns;
+        applyHiddenColumns();
+    }
+
+    void BsonTableView::applyHiddenColumns()
+    {
+        if (!model())
+            return;
+
+        for (int column = 0; column < model()->columnCount(); ++column)
+            setColumnHidden(column, _hiddenColumns.contains(columnName(column)));
+    }
+
+    QStringList BsonTableView::visibleColumns() const
+    {
+        QStringList columns;
+        if (!model())
+            return columns;
+
+        for (int column = 0; column < model()->columnCount(); ++column) {
+            if (!isColumnHidden(column))
+                columns.append(columnName(column));
+        }
+        return columns;
+    }
+
+    bool BsonTableView::hasColumn(const QString &name) const
+    {
+        if (!model())
+            return false;
+
+        for (int column = 0; column < model()->columnCount(); ++column) {
+            if (columnName(column) == name)
+                return true;
+        }
+        return false;
+    }
+
+    QString BsonTableView::columnName(int column) const
+    {
+        return model()->headerData(column, Qt::Horizontal).toString();
+    }
+
+    void BsonTableView::showHeaderMenu(const QPoint &point)
+    {
+        if (!model())
+            return;
+
+        QMenu menu(this);
+        QStringList names;
+        for (int column = 0; column < model()->columnCount(); ++column)
+            names.append(columnName(column));
+
+        // Hidden columns that were not loaded are listed after loaded ones
+        for (int i = 0; i < _hiddenColumns.count(); ++i) {
+            if (!names.contains(_hiddenColumns[i]))
+                names.append(_hiddenColumns[i]);
+        }
+
+        for (int i = 0; i < names.count(); ++i) {
+            QAction *action = menu.addAction(names[i]);
+            action->setData(names[i]);
+            action->setCheckable(true);
+            action->setChecked(!_hiddenColumns.contains(names[i]));
+        }
+
+        menu.addSeparator();
+        QAction *showAll = menu.addAction("Show All Columns");
+        showAll->setEnabled(!_hiddenColumns.isEmpty());
+
+        QAction *chosen = menu.exec(horizontalHeader()->mapToGlobal(point));
+        if (!chosen)
+            return;
+
+        if (chosen == showAll) {
+            _hiddenColumns.clear();
+        }
+        else {
+            const QString name = chosen->data().toString();
+            if (chosen->isChecked()) {
+                _hiddenColumns.removeAll(name);
+            }
+            else {
+                // At least one column stays visible
+                if (visibleColumns() == QStringList(name))
+                    return;
+                _hiddenColumns.append(name);
+            }
+        }
+
+        applyHiddenColumns();
+        emit hiddenColumnsChanged();
     }
 
     void BsonTableView::keyPressEvent(QKeyEvent *event)
@@ -52,6 +165,22 @@ namespace Robomongo
         return detail::uniqueRows(selectionModel()->selectedIndexes());
     }
 
+    void BsonTableView::showPath(const BsonPath &path)
+    {
+        BsonTableModel *tableModel = qobject_cast<BsonTableModel *>(model());
+        if (!tableModel || path.size() < 2)
+            return;
+
+        int row = tableModel->rowOfDocument(path[0]);
+        int column = tableModel->columnOfField(path[0], path[1]);
+        if (row < 0 || column < 0)
+            return;
+
+        QModelIndex index = tableModel->index(row, column);
+        setCurrentIndex(index);
+        scrollTo(index);
+    }
+
     void BsonTableView::showContextMenu( const QPoint &point )
     {
         QPoint menuPoint = mapToGlobal(point);
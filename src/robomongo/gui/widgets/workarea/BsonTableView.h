@@ -1,7 +1,9 @@
 #pragma once
 #include <QTableView>
+#include <QStringList>
 
 #include "robomongo/core/domain/Notifier.h"
+#include "robomongo/gui/widgets/workarea/BsonSearchThread.h"
 
 namespace Robomongo
 {
@@ -14,13 +16,47 @@ namespace Robomongo
         virtual QModelIndex selectedIndex() const;
         virtual QModelIndexList selectedIndexes() const;
 
+        /**
+         * @brief Selects cell of top-level field of 'path'. Nothing is
+         * selected when document is hidden by filter.
+         */
+        void showPath(const BsonPath &path);
+
+        virtual void setModel(QAbstractItemModel *model);
+
+        /**
+         * @brief Names of columns hidden by user. Hidden column may be absent
+         * in current model, when documents were loaded with projection.
+         */
+        QStringList hiddenColumns() const { return _hiddenColumns; }
+        void setHiddenColumns(const QStringList &columns);
+        QStringList visibleColumns() const;
+        bool hasColumn(const QString &name) const;
+
+    Q_SIGNALS:
+        /**
+         * @brief Signals when user hides or shows column
+         */
+        void hiddenColumnsChanged();
+
     public Q_SLOTS:
         void showContextMenu(const QPoint &point);
 
+    private Q_SLOTS:
+        void showHeaderMenu(const QPoint &point);
+
+        /**
+         * @brief Hides columns of _hiddenColumns, header shows all sections after model reset
+         */
+        void applyHiddenColumns();
+
     protected:
         virtual void keyPressEvent(QKeyEvent *event);
 
     private:
+        QString columnName(int column) const;
+
         Notifier _notifier;
+        QStringList _hiddenColumns;
     };
 }
@@ -1,157 +1,230 @@
 #include "robomongo/gui/widgets/workarea/BsonTreeItem.h"
+
+#include <algorithm>
 #include <mongo/client/dbclientinterface.h>
 
-using namespace mongo;
+#include "robomongo/core/utils/BsonUtils.h"
+#include "robomongo/core/utils/QtUtils.h"
+
 namespace
 {
-    struct removeIfFound : public std::unary_function<const Robomongo::BsonTreeItem*, bool> 
-    {
-        removeIfFound(Robomongo::BsonTreeItem *item) :_whatSearch(item) {}
-        bool operator()(const Robomongo::BsonTreeItem* item) const
-        {
-            if (item == _whatSearch) {
-                delete _whatSearch;
-                return true;
-            }
-            return false;
-        }
-        const Robomongo::BsonTreeItem *const _whatSearch;
-    };
-
-    const Robomongo::BsonTreeItem *findSuperRoot(const Robomongo::BsonTreeItem *const item)
-    {
-        Robomongo::BsonTreeItem *parent = qobject_cast<Robomongo::BsonTreeItem *>(item->parent());
-        if (parent) {
-            Robomongo::BsonTreeItem *grParent = qobject_cast<Robomongo::BsonTreeItem *>(parent->parent());
-            if (grParent) {
-               return findSuperRoot(parent);
-            }
-        }
-        return item;
+    QString arrayValue(int itemsCount) {
+        QString elements = itemsCount == 1 ? "element" : "elements";
+        return QString("[ %1 %2 ]").arg(itemsCount).arg(elements);
     }
-}
-namespace Robomongo
-{
-    BsonTreeItem::BsonTreeItem(QObject *parent) 
-        :BaseClass(parent)
-    {
-       
+
+    QString objectValue(int itemsCount) {
+        QString fields = itemsCount == 1 ? "field" : "fields";
+        return QString("{ %1 %2 }").arg(itemsCount).arg(fields);
     }
 
-    BsonTreeItem::BsonTreeItem(const mongo::BSONObj &bsonObjRoot, QObject *parent)
-        :BaseClass(parent),
-        _root(bsonObjRoot)
-    {
+    QString truncatedValue(const mongo::BSONObj &marker, Robomongo::UUIDEncoding uuidEncoding, Robomongo::SupportedTimes timeZone) {
+        using namespace Robomongo;
+        long long size = marker.firstElement().numberLong();
+        mongo::BSONElement value = marker.getField("value");
 
-    }
+        if (value.type() == mongo::Array)
+            return QString("[ %1 of %2 elements, truncated ]").arg(BsonUtils::elementsCount(value.Obj())).arg(size);
 
-    unsigned BsonTreeItem::childrenCount() const
-    {
-        return _items.size();
+        std::string result;
+        BsonUtils::buildJsonString(value, result, uuidEncoding, timeZone);
+        return QString("%1... (%2 characters, truncated)").arg(QtUtils::toQString(result)).arg(size);
     }
+}
 
-    void BsonTreeItem::clear()
+namespace Robomongo
+{
+    BsonTreeItem::BsonTreeItem(BsonTreeArena *arena, int parent, int row, int document, int offset, mongo::BSONType type) :
+        _arena(arena),
+        _parent(parent),
+        _row(row),
+        _document(document),
+        _offset(offset),
+        _firstChild(-1),
+        _childrenCount(0),
+        _type(static_cast<signed char>(type))
     {
-        _items.clear();
-    }
 
-    void BsonTreeItem::addChild(BsonTreeItem *item)
-    {
-        _items.push_back(item);
     }
 
     BsonTreeItem* BsonTreeItem::child(unsigned pos) const
     {
-        return _items[pos];
+        return _arena->item(_firstChild + pos);
     }
 
     BsonTreeItem* BsonTreeItem::childSafe(unsigned pos) const
     {
         if (childrenCount() > pos) {
-            return _items[pos];
+            return child(pos);
         }
         else {
             return NULL;
         }
     }
 
-    BsonTreeItem* BsonTreeItem::childByKey(const QString &val)
+    BsonTreeItem* BsonTreeItem::childByKey(const QString &val) const
     {
-        for (unsigned i = 0; i < _items.size(); ++i) {
-            if (_items[i]->key() == val) {
-                return _items[i];
+        for (unsigned i = 0; i < childrenCount(); ++i) {
+            BsonTreeItem *item = child(i);
+            if (item->key() == val) {
+                return item;
             }
         }
         return NULL;
     }
 
+    BsonTreeItem *BsonTreeItem::parent() const
+    {
+        if (_offset < 0)
+            return NULL;
+
+        if (_parent < 0)
+            return _arena->document(_document);
+
+        return _arena->item(_parent);
+    }
+
     const BsonTreeItem *BsonTreeItem::superParent() const
     {
-        return findSuperRoot(this);
+        return _arena->document(_document);
     }
 
     mongo::BSONObj BsonTreeItem::superRoot() const
     {
-        return superParent()->root();
+        return _arena->documentObj(_document);
     }
 
-    mongo::BSONObj BsonTreeItem::root() const
+    mongo::BSONElement BsonTreeItem::element() const
     {
-        return _root;
+        if (_offset < 0)
+            return mongo::BSONElement();
+
+        return mongo::BSONElement(_arena->documentObj(_document).objdata() + _offset);
     }
 
-    int BsonTreeItem::indexOf(BsonTreeItem *item) const
+    mongo::BSONObj BsonTreeItem::obj() const
     {
-        for (unsigned i = 0; i < _items.size(); ++i) {
-            if (item == _items[i]) {
-                return i;
-            }
-        }
-        return -1;
+        if (_offset < 0)
+            return superRoot();
+
+        mongo::BSONElement elem = element();
+        return elem.isABSONObj() ? elem.Obj() : mongo::BSONObj();
     }
 
-    QString BsonTreeItem::key() const
+    std::string BsonTreeItem::fieldName() const
     {
-        return _fields._key;
+        if (_offset < 0)
+            return std::string();
+
+        return element().fieldName();
     }
 
-    QString BsonTreeItem::value() const
+    QString BsonTreeItem::key() const
     {
-        return _fields._value;
+        if (_offset < 0) {
+            // Top-level documents are labeled with position and value of _id
+            QString idValue;
+            mongo::BSONElement id = superRoot().getField("_id");
+            if (!id.eoo()) {
+                std::string result;
+                BsonUtils::buildJsonString(id, result, _arena->uuidEncoding(), _arena->timeZone());
+                idValue = QtUtils::toQString(result);
+            }
+            return QString("(%1) %2").arg(_row + 1).arg(idValue);
+        }
+
+        QString uiFieldName = QtUtils::toQString(fieldName());
+
+        // When we iterate array, show field names in square brackets
+        // In this case field names are numeric, starting from 0.
+        if (BsonUtils::isArray(parent()->type()))
+            return "[" + uiFieldName + "]";
+
+        return uiFieldName;
     }
 
-    mongo::BSONType BsonTreeItem::type() const
+    QString BsonTreeItem::value() const
     {
-        return _fields._type;
+        // Full value is loaded when node is expanded
+        if (isTruncated())
+            return truncatedValue(element().Obj(), _arena->uuidEncoding(), _arena->timeZone());
+
+        if (BsonUtils::isDocument(type())) {
+            int count = isPopulated() ? _childrenCount : BsonUtils::elementsCount(obj());
+            return BsonUtils::isArray(type()) ? arrayValue(count) : objectValue(count);
+        }
+
+        std::string result;
+        BsonUtils::buildJsonString(element(), result, _arena->uuidEncoding(), _arena->timeZone());
+        return QtUtils::toQString(result);
     }
 
-    void BsonTreeItem::setKey(const QString &key)
+    bool BsonTreeItem::isTruncated() const
     {
-        _fields._key = key;
+        // Server truncates only top-level fields, user's own documents of the same
+        // shape (and any nested ones) are shown as they are
+        return _arena->hasTruncatedValues() && _offset >= 0 && _parent < 0
+               && type() == mongo::Object && BsonUtils::isTruncated(element());
     }
 
-    void BsonTreeItem::setValue(const QString &value)
+    mongo::BinDataType BsonTreeItem::binType() const
     {
-        _fields._value = value;
+        if (type() != mongo::BinData)
+            return mongo::BinDataGeneral;
+
+        return element().binDataType();
     }
 
-    void BsonTreeItem::setType(mongo::BSONType type)
+    BsonTreeArena::BsonTreeArena(const PreparedDocumentsPtr &documents, UUIDEncoding uuidEncoding, SupportedTimes timeZone) :
+        _documents(documents),
+        _uuidEncoding(uuidEncoding),
+        _timeZone(timeZone)
     {
-       _fields._type = type;
+
     }
 
-    mongo::BinDataType BsonTreeItem::binType() const
+    int BsonTreeArena::fetchDocuments(int count)
     {
-        return _fields._binType;
+        int first = fetchedDocumentsCount();
+        int last = std::min(first + count, documentsCount());
+        for (int i = first; i < last; ++i) {
+            BsonTreeItem item(this, -1, i, i, -1, documentObj(i).isArray() ? mongo::Array : mongo::Object);
+            _documentItems.push_back(item);
+        }
+        return last - first;
     }
 
-    void BsonTreeItem::setBinType(mongo::BinDataType type)
+    void BsonTreeArena::populate(BsonTreeItem *item)
     {
-        _fields._binType = type;
+        if (item->isPopulated() || !BsonUtils::isDocument(item->type()))
+            return;
+
+        const int parent = indexOf(item);
+        const char *const base = documentObj(item->_document).objdata();
+        const int firstChild = static_cast<int>(_items.size());
+
+        int row = 0;
+        mongo::BSONObjIterator iterator(item->obj());
+        while (iterator.more()) {
+            mongo::BSONElement element = iterator.next();
+            int offset = static_cast<int>(element.rawdata() - base);
+            _items.push_back(BsonTreeItem(this, parent, row++, item->_document, offset, element.type()));
+        }
+
+        item->_firstChild = firstChild;
+        item->_childrenCount = row;
     }
 
-    void BsonTreeItem::removeChild(BsonTreeItem *item)
+    int BsonTreeArena::indexOf(const BsonTreeItem *item) const
     {
-        _items.erase(std::remove_if(_items.begin(), _items.end(), removeIfFound(item)), _items.end());
+        // Top-level documents are not stored in _items, their fields refer
+        // to them through _document
+        if (item->_offset < 0)
+            return -1;
+
+        if (item->_parent < 0)
+            return _documentItems[item->_document]._firstChild + item->_row;
+
+        return _items[item->_parent]._firstChild + item->_row;
     }
 }
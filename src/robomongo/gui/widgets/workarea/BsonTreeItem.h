@@ -1,26 +1,30 @@
 #pragma once
 
+#include <deque>
 #include <vector>
-#include <QObject>
+#include <QString>
 #include <mongo/bson/bsonobj.h>
 #include <mongo/bson/bsonelement.h>
 
+#include "robomongo/core/Enums.h"
+#include "robomongo/gui/widgets/workarea/ModelPrepareThread.h"
+
 namespace Robomongo
 {
+    class BsonTreeArena;
+
     /**
-     * @brief BSON tree item (represents array or object)
+     * @brief Compact node of BSON tree. Node doesn't own any data: it only knows
+     * index of its parent in the arena, offset of its BSON element inside of the
+     * top-level document and element type. Key and value strings are built on demand.
+     *
+     * Nodes are owned by BsonTreeArena and are never moved, so pointers to nodes
+     * (used as internal pointers of QModelIndex) are valid while arena is alive.
      */
-    struct BsonItemFields
+    class BsonTreeItem
     {
-        QString _key;
-        QString _value;
-        mongo::BSONType _type;
-        mongo::BinDataType _binType;
-    };
+        friend class BsonTreeArena;
 
-    class BsonTreeItem : public QObject
-    {
-        Q_OBJECT
     public:
         enum eColumn
         {
@@ -30,45 +34,116 @@ namespace Robomongo
             eCountColumns = 3
         };
 
-        typedef QObject BaseClass;
-        typedef std::vector<BsonTreeItem*> ChildContainerType;
+        /**
+         * @brief Number of populated children. Children of document or
+         * array are populated by BsonTreeArena::populate()
+         */
+        unsigned childrenCount() const { return _childrenCount; }
+        bool isPopulated() const { return _firstChild >= 0; }
+
+        BsonTreeItem *child(unsigned pos) const;
+        BsonTreeItem *childSafe(unsigned pos) const;
+        BsonTreeItem *childByKey(const QString &val) const;
 
-        explicit BsonTreeItem(QObject *parent = 0);
-        explicit BsonTreeItem(const mongo::BSONObj &bsonObjRoot, QObject *parent = 0);
+        /**
+         * @brief Parent of this node, or NULL for top-level documents
+         */
+        BsonTreeItem *parent() const;
 
-        unsigned childrenCount() const;
-        void clear();
-        void addChild(BsonTreeItem *item);
-        void removeChild(BsonTreeItem *item);
-        BsonTreeItem* child(unsigned pos) const;
-        BsonTreeItem* childSafe(unsigned pos) const;
-        BsonTreeItem* childByKey(const QString &val);
-        int indexOf(BsonTreeItem *item) const;
+        /**
+         * @brief Row of this node in its parent (or among top-level documents)
+         */
+        int row() const { return _row; }
 
-        const BsonTreeItem* superParent() const;
-        mongo::BSONObj root() const;
+        const BsonTreeItem *superParent() const;
         mongo::BSONObj superRoot() const;
 
-        std::string fieldName() const { return _fieldName; };
-        void setFieldName(const std::string &fieldName) { _fieldName = fieldName; };
+        /**
+         * @brief BSON element of this node. Top-level documents are not elements,
+         * for them EOO element is returned.
+         */
+        mongo::BSONElement element() const;
 
-        QString key() const;
-        void setKey(const QString &key);
+        /**
+         * @brief Object or array represented by this node (empty for simple types)
+         */
+        mongo::BSONObj obj() const;
 
+        std::string fieldName() const;
+        QString key() const;
         QString value() const;
-        void setValue(const QString &value);
+        mongo::BSONType type() const { return static_cast<mongo::BSONType>(_type); }
+        mongo::BinDataType binType() const;
 
-        mongo::BSONType type() const;
-        void setType(mongo::BSONType type);
+        /**
+         * @brief True when value of this top-level field was truncated on server
+         * (result was loaded with MongoQueryInfo::_truncateValues)
+         */
+        bool isTruncated() const;
 
-        mongo::BinDataType binType() const;
-        void setBinType(mongo::BinDataType type);
+    private:
+        BsonTreeItem(BsonTreeArena *arena, int parent, int row, int document, int offset, mongo::BSONType type);
+
+        BsonTreeArena *_arena;
+        int _parent;           // index of parent in arena, -1 for top-level documents and their fields
+        int _row;
+        int _document;         // index of top-level document
+        int _offset;           // offset of element in document, -1 for top-level documents
+        int _firstChild;       // index of first child in arena, -1 until children are populated
+        int _childrenCount;
+        signed char _type;
+    };
+
+    /**
+     * @brief Flat storage of BsonTreeItem nodes. Nodes of top-level documents are kept
+     * separately and are created in chunks by fetchDocuments(). Children of every node
+     * are appended as contiguous block when node is populated. It makes child, parent
+     * and row lookups O(1).
+     */
+    class BsonTreeArena
+    {
+    public:
+        BsonTreeArena(const PreparedDocumentsPtr &documents, UUIDEncoding uuidEncoding, SupportedTimes timeZone);
+
+        /**
+         * @brief Total number of documents and number of documents that already have nodes
+         */
+        int documentsCount() const { return static_cast<int>(_documents->_documents.size()); }
+        int fetchedDocumentsCount() const { return static_cast<int>(_documentItems.size()); }
+
+        /**
+         * @brief Creates nodes for next 'count' (or less, if not available) documents.
+         * Returns number of created nodes.
+         */
+        int fetchDocuments(int count);
+
+        BsonTreeItem *document(int row) { return &_documentItems[row]; }
+        const mongo::BSONObj &documentObj(int index) const { return _documents->_documents[index]; }
+
+        BsonTreeItem *item(int index) { return &_items[index]; }
+        const BsonTreeItem *item(int index) const { return &_items[index]; }
+        size_t itemsCount() const { return _items.size(); }
+
+        /**
+         * @brief Appends children of object or array 'item' to the arena.
+         * Does nothing if 'item' is already populated or is not a document.
+         */
+        void populate(BsonTreeItem *item);
+
+        UUIDEncoding uuidEncoding() const { return _uuidEncoding; }
+        SupportedTimes timeZone() const { return _timeZone; }
+        bool hasTruncatedValues() const { return _documents->_truncatedValues; }
+
+    private:
+        BsonTreeArena(const BsonTreeArena &) = delete;
+        BsonTreeArena &operator=(const BsonTreeArena &) = delete;
 
-    protected:
+        int indexOf(const BsonTreeItem *item) const;
 
-        const mongo::BSONObj _root;
-        ChildContainerType _items;
-        BsonItemFields _fields;
-        std::string _fieldName;
+        const PreparedDocumentsPtr _documents;
+        std::deque<BsonTreeItem> _documentItems;
+        std::deque<BsonTreeItem> _items;
+        const UUIDEncoding _uuidEncoding;
+        const SupportedTimes _timeZone;
     };
 }
@@ -1,5 +1,6 @@
 #include "robomongo/gui/widgets/workarea/BsonTreeModel.h"
 
+#include <algorithm>
 #include <mongo/client/dbclientinterface.h>
 #include "robomongo/core/settings/SettingsManager.h"
 #include "robomongo/core/AppRegistry.h"
@@ -9,110 +10,60 @@
 #include "robomongo/core/utils/QtUtils.h"
 #include "robomongo/gui/GuiRegistry.h"
 
-namespace
-{
-    using namespace Robomongo;
-
-    QString arrayValue(int itemsCount) {
-        QString elements = itemsCount == 1 ? "element" : "elements";
-        return QString("[ %1 %2 ]").arg(itemsCount).arg(elements);
-    }
-
-    QString objectValue(int itemsCount) {
-        QString fields = itemsCount == 1 ? "field" : "fields";
-        return QString("{ %1 %2 }").arg(itemsCount).arg(fields);
-    }
-
-    void parseDocument(BsonTreeItem *root, const mongo::BSONObj &doc, bool isArray)
-    {            
-            mongo::BSONObjIterator iterator(doc);
-            while (iterator.more())
-            {
-                mongo::BSONElement element = iterator.next();                
-                BsonTreeItem *childItemInner = new BsonTreeItem(doc, root);
-                std::string fieldName = std::string(element.fieldName());
-                childItemInner->setFieldName(fieldName);
-
-                QString uiFieldName = QtUtils::toQString(fieldName);
-                childItemInner->setKey(uiFieldName);
-
-                if (isArray) {
-                    // When we iterate array, show field names in square brackets
-                    // In this case field names are numeric, starting from 0.
-                    childItemInner->setKey("[" + uiFieldName + "]");
-                }
-
-                if (BsonUtils::isArray(element)) {
-                    int itemsCount = element.Array().size();
-                    childItemInner->setValue(arrayValue(itemsCount));
-                }
-                else if (BsonUtils::isDocument(element)) {
-                    int count = BsonUtils::elementsCount(element.Obj());
-                    childItemInner->setValue(objectValue(count));
-                }
-                else {
-                    std::string result;
-                    BsonUtils::buildJsonString(element, result, AppRegistry::instance().settingsManager()->uuidEncoding(), AppRegistry::instance().settingsManager()->timeZone());
-                    childItemInner->setValue(QtUtils::toQString(result));
-                }
-                childItemInner->setType(element.type());
-                if (element.type() == mongo::BinData) {
-                    childItemInner->setBinType(element.binDataType());
-                }
-                root->addChild(childItemInner);
-                //root->setValue(QString("{ %1 fields }").arg(root->childrenCount()));
-            }            
-    }
-}
-
 namespace Robomongo
 {
-    BsonTreeModel::BsonTreeModel(const std::vector<MongoDocumentPtr> &documents, QObject *parent) :
+    BsonTreeModel::BsonTreeModel(const PreparedDocumentsPtr &documents, QObject *parent) :
         BaseClass(parent),
-        _root(new BsonTreeItem(this))
+        _arena(new BsonTreeArena(documents,
+                                 AppRegistry::instance().settingsManager()->uuidEncoding(),
+                                 AppRegistry::instance().settingsManager()->timeZone())),
+        _formatted(formattedCacheSize)
     {
-        for (int i = 0; i < documents.size(); ++i) {
-            MongoDocumentPtr doc = documents[i]; 
-            BsonTreeItem *child = new BsonTreeItem(doc->bsonObj(), _root);
-            parseDocument(child, doc->bsonObj(), doc->bsonObj().isArray());
-
-            QString idValue;
-            BsonTreeItem *idItem = child->childByKey("_id");
-            if (idItem) {
-                idValue = idItem->value();
-            }
-
-            child->setKey(QString("(%1) %2").arg(i + 1).arg(idValue));
+        // Rest of documents and fields of documents are populated and
+        // formatted on demand (see fetchMore and data)
+        _arena->fetchDocuments(documentsBatchSize);
+    }
 
-            int count = BsonUtils::elementsCount(doc->bsonObj());
+    BsonTreeModel::~BsonTreeModel()
+    {
 
-            if (doc->bsonObj().isArray()) {
-                child->setValue(arrayValue(count));
-                child->setType(mongo::Array);
-            } else {
-                child->setValue(objectValue(count));
-                child->setType(mongo::Object);
-            }
-            _root->addChild(child);
-        }
     }
 
     void BsonTreeModel::fetchMore(const QModelIndex &parent)
     {
+        if (!parent.isValid()) {
+            int first = _arena->fetchedDocumentsCount();
+            int count = std::min<int>(documentsBatchSize, _arena->documentsCount() - first);
+            if (count > 0) {
+                beginInsertRows(parent, first, first + count - 1);
+                _arena->fetchDocuments(count);
+                endInsertRows();
+            }
+            return;
+        }
+
         BsonTreeItem *node = QtUtils::item<BsonTreeItem*>(parent);
-        if (node) {
-            mongo::BSONElement elem = BsonUtils::indexOf(node->root(), parent.row());
-            if (!elem.isNull() && elem.isABSONObj()) {
-                parseDocument(node, elem.Obj(), elem.type() == mongo::Array);
-            }            
+        if (node && !node->isPopulated()) {
+            int count = BsonUtils::elementsCount(node->obj());
+            if (count > 0) {
+                beginInsertRows(parent, 0, count - 1);
+                _arena->populate(node);
+                endInsertRows();
+            }
+            else {
+                _arena->populate(node);
+            }
         }
         return BaseClass::fetchMore(parent);
     }
 
     bool BsonTreeModel::canFetchMore(const QModelIndex &parent) const
     {
+        if (!parent.isValid())
+            return _arena->fetchedDocumentsCount() < _arena->documentsCount();
+
         BsonTreeItem *node = QtUtils::item<BsonTreeItem*>(parent);
-        if (node && !node->childrenCount()) {
+        if (node && !node->isPopulated()) {
             return BsonUtils::isDocument(node->type());
         }
         return false;
@@ -127,6 +78,38 @@ namespace Robomongo
         return true;
     }
 
+    QString BsonTreeModel::key(BsonTreeItem *item) const
+    {
+        return formatted(item)._key;
+    }
+
+    QString BsonTreeModel::value(BsonTreeItem *item) const
+    {
+        return formatted(item)._value;
+    }
+
+    BsonTreeModel::FormattedItem BsonTreeModel::formatted(BsonTreeItem *item) const
+    {
+        if (FormattedItem *cached = _formatted.object(item))
+            return *cached;
+
+        FormattedItem *result = new FormattedItem;
+        result->_key = item->key();
+        result->_value = item->value();
+
+        // View shows a few hundred characters at most. Huge values are cut, otherwise
+        // QCache would drop them on insert and they would be formatted on every repaint.
+        if (result->_key.size() > formattedTextSize)
+            result->_key = result->_key.left(formattedTextSize) + "...";
+        if (result->_value.size() > formattedTextSize)
+            result->_value = result->_value.left(formattedTextSize) + "...";
+
+        // Cache takes ownership
+        FormattedItem copy = *result;
+        _formatted.insert(item, result, copy._key.size() + copy._value.size() + 1);
+        return copy;
+    }
+
     const QIcon &BsonTreeModel::getIcon(BsonTreeItem *item)
     {
         switch(item->type()) {
@@ -176,20 +159,21 @@ namespace Robomongo
         if (role == Qt::DisplayRole || role == Qt::ToolTipRole) {
             if (col == BsonTreeItem::eKey) {
                 if (role == Qt::DisplayRole) {
-                    result = node->key();
+                    result = key(node);
                 }
             }
             else if (col == BsonTreeItem::eValue) {
                 bool isCut = node->type() == mongo::String ||  node->type() == mongo::Code || node->type() == mongo::CodeWScope;  
+                QString nodeValue = value(node);
                 if (role == Qt::ToolTipRole) {
-                    result = isCut ? node->value().left(500) : node->value(); 
+                    result = isCut ? nodeValue.left(500) : nodeValue; 
                 }
                 else{
-                    result = isCut ? node->value().simplified().left(300) : node->value(); 
+                    result = isCut ? nodeValue.simplified().left(300) : nodeValue; 
                 }
             }
             else if (col == BsonTreeItem::eType) {
-                result = BsonUtils::BSONTypeToString(node->type(), node->binType(), AppRegistry::instance().settingsManager()->uuidEncoding());
+                result = BsonUtils::BSONTypeToString(node->type(), node->binType(), _arena->uuidEncoding());
             }
         }       
 
@@ -207,12 +191,10 @@ namespace Robomongo
 
     int BsonTreeModel::rowCount(const QModelIndex &parent) const
     {
-        const BsonTreeItem *parentItem = NULL;
-        if (parent.isValid())
-            parentItem = QtUtils::item<BsonTreeItem*>(parent);
-        else
-            parentItem = _root;
+        if (!parent.isValid())
+            return _arena->fetchedDocumentsCount();
 
+        const BsonTreeItem *parentItem = QtUtils::item<BsonTreeItem*>(parent);
         return parentItem->childrenCount();
     }
 
@@ -246,11 +228,9 @@ namespace Robomongo
         QModelIndex result;
         if (index.isValid()) {
             BsonTreeItem *const childItem = QtUtils::item<BsonTreeItem*const>(index);
-            BsonTreeItem *const parentItem = static_cast<BsonTreeItem*const>(childItem->parent());
-            if (parentItem && parentItem != _root) {
-                BsonTreeItem *const grandParent = static_cast<BsonTreeItem*const>(parentItem->parent());
-                int row = grandParent->indexOf(parentItem);
-                result = createIndex(row, 0, parentItem);
+            BsonTreeItem *const parentItem = childItem->parent();
+            if (parentItem) {
+                result = createIndex(parentItem->row(), 0, parentItem);
             }
         }
         return result;
@@ -260,39 +240,17 @@ namespace Robomongo
     {
         QModelIndex index;
         if (hasIndex(row, column, parent)) {
-            const BsonTreeItem * parentItem = NULL;
+            BsonTreeItem *childItem = NULL;
             if (!parent.isValid()) {
-                parentItem = _root;
+                childItem = _arena->document(row);
             } else {
-                parentItem = QtUtils::item<BsonTreeItem*>(parent);
+                childItem = QtUtils::item<BsonTreeItem*>(parent)->childSafe(row);
             }
 
-            BsonTreeItem *childItem = parentItem->child(row);
             if (childItem) {
                 index = createIndex(row, column, childItem);
             }
         }
         return index;
     }
-
-    void BsonTreeModel::insertItem(BsonTreeItem *parent, BsonTreeItem *children)
-    {
-        QModelIndex index = createIndex(0, 0, parent);
-        unsigned child_count = parent->childrenCount();
-        beginInsertRows(index, child_count, child_count);
-        parent->addChild(children);
-        endInsertRows();
-    }
-
-    void BsonTreeModel::removeitem(BsonTreeItem *children)
-    {
-        BsonTreeItem *parent = static_cast<BsonTreeItem *>(children->parent());
-        if (parent) {
-            QModelIndex index = createIndex(0, 0, parent);
-            int row = parent->indexOf(children);
-            beginRemoveRows(index, row, row);
-            parent->removeChild(children);
-            endRemoveRows();
-        }
-    }
 }
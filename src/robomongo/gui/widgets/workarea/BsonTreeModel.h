@@ -1,11 +1,14 @@
 #pragma once
+#include <memory>
 #include <vector>
 #include <QAbstractItemModel>
-#include "robomongo/core/Core.h"
+#include <QCache>
+#include "robomongo/gui/widgets/workarea/ModelPrepareThread.h"
 
 namespace Robomongo
 {
     class BsonTreeItem;
+    class BsonTreeArena;
 
     class BsonTreeModel : public QAbstractItemModel
     {
@@ -14,7 +17,8 @@ namespace Robomongo
     public:
         typedef QAbstractItemModel BaseClass;
         static const QIcon &getIcon(BsonTreeItem *item);
-        explicit BsonTreeModel(const std::vector<MongoDocumentPtr> &documents, QObject *parent = 0);
+        explicit BsonTreeModel(const PreparedDocumentsPtr &documents, QObject *parent = 0);
+        ~BsonTreeModel();
         QVariant data(const QModelIndex &index, int role) const;
 
         int rowCount(const QModelIndex &parent = QModelIndex()) const;
@@ -25,13 +29,32 @@ namespace Robomongo
         virtual QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const;
         virtual QModelIndex parent(const QModelIndex& index) const;
 
-        void insertItem(BsonTreeItem *parent, BsonTreeItem *children);
-        void removeitem(BsonTreeItem *children);
-
         virtual void fetchMore(const QModelIndex &parent);
         virtual bool canFetchMore(const QModelIndex &parent) const;
         virtual bool hasChildren(const QModelIndex &parent = QModelIndex()) const;
+
+        /**
+         * @brief Key and value strings of 'item', as displayed. Strings are formatted when they
+         * are requested for the first time and are kept in LRU cache of limited size.
+         * Strings longer than 'formattedTextSize' are cut, so that every item fits in cache.
+         */
+        QString key(BsonTreeItem *item) const;
+        QString value(BsonTreeItem *item) const;
+
     protected:
-        BsonTreeItem *const _root;
+        enum { formattedCacheSize = 4 * 1024 * 1024 }; // in characters
+        enum { formattedTextSize = 16 * 1024 };         // in characters, per key and per value
+        enum { documentsBatchSize = 500 };              // top-level rows added by one fetchMore()
+
+        struct FormattedItem
+        {
+            QString _key;
+            QString _value;
+        };
+
+        FormattedItem formatted(BsonTreeItem *item) const;
+
+        const std::unique_ptr<BsonTreeArena> _arena;
+        mutable QCache<const BsonTreeItem *, FormattedItem> _formatted;
     };
 }
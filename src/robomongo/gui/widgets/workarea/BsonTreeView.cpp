@@ -4,6 +4,9 @@
 #include <QAction>
 #include <QMenu>
 #include <QKeyEvent>
+#include <QLabel>
+#include <QTimer>
+#include <QElapsedTimer>
 
 #include "robomongo/gui/widgets/workarea/BsonTreeItem.h"
 
@@ -13,7 +16,7 @@
 namespace Robomongo
 {
     BsonTreeView::BsonTreeView(MongoShell *shell, const MongoQueryInfo &queryInfo, QWidget *parent)
-        : BaseClass(parent), _notifier(this, shell, queryInfo)
+        : BaseClass(parent), _notifier(this, shell, queryInfo), _expandedNodes(0)
     {
 #if defined(Q_OS_MAC)
         setAttribute(Qt::WA_MacShowFocusRect, false);
@@ -32,6 +35,18 @@ namespace Robomongo
         _collapseRecursive->setShortcut(QKeySequence(Qt::ALT + Qt::Key_Left));
         VERIFY(connect(_collapseRecursive, SIGNAL(triggered()), SLOT(onCollapseRecursive())));
 
+        _saveResult = new QAction("Save Result to File...", this);
+        VERIFY(connect(_saveResult, SIGNAL(triggered()), SIGNAL(saveResultRequested())));
+
+        // Recursive expansion is done step by step, when event loop is idle
+        _expandTimer = new QTimer(this);
+        _expandTimer->setInterval(0);
+        VERIFY(connect(_expandTimer, SIGNAL(timeout()), this, SLOT(expandStep())));
+
+        _expandProgress = new QLabel(this);
+        _expandProgress->setStyleSheet("QLabel { background-color: #fdf6c4; border: 1px solid #c7c5c4; padding: 3px; }");
+        _expandProgress->hide();
+
         setStyleSheet("QTreeView { border-left: 1px solid #c7c5c4; border-top: 1px solid #c7c5c4; }");
 #if (QT_VERSION >= QT_VERSION_CHECK(5, 0, 0))
         header()->setSectionResizeMode(QHeaderView::Interactive);
@@ -52,6 +67,8 @@ namespace Robomongo
             menu.addSeparator();
             
             _notifier.initMultiSelectionMenu(&menu);
+            menu.addSeparator();
+            menu.addAction(_saveResult);
             menu.exec(menuPoint);
         }
         else {
@@ -71,6 +88,8 @@ namespace Robomongo
             }
 
             _notifier.initMenu(&menu, documentItem);
+            menu.addSeparator();
+            menu.addAction(_saveResult);
             menu.exec(menuPoint);
         }
     }
@@ -79,6 +98,7 @@ namespace Robomongo
     {
         BaseClass::resizeEvent(event);
         header()->resizeSections(QHeaderView::Stretch);
+        updateExpandProgress();
     }
 
     void BsonTreeView::keyPressEvent(QKeyEvent *event)
@@ -100,6 +120,12 @@ namespace Robomongo
                 if (event->modifiers() & Qt::AltModifier)
                     this->onCollapseRecursive();
                 break;
+            case Qt::Key_Escape:
+                if (_expandTimer->isActive()) {
+                    cancelExpand();
+                    return event->accept();
+                }
+                break;
         }
 
         return BaseClass::keyPressEvent(event);
@@ -107,16 +133,91 @@ namespace Robomongo
 
     void BsonTreeView::expandNode(const QModelIndex &index)
     {
-        if (index.isValid()) {
+        if (!index.isValid())
+            return;
+
+        if (!_expandTimer->isActive())
+            _expandedNodes = 0;
+
+        _expandQueue.push_back(QPersistentModelIndex(index));
+        _expandTimer->start();
+        updateExpandProgress();
+    }
+
+    void BsonTreeView::expandStep()
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        while (!_expandQueue.empty() && timer.elapsed() < expandSliceMs) {
+            if (_expandedNodes >= maxExpandedNodes) {
+                cancelExpand();
+                showExpandProgress(QString("Expansion stopped after %1 nodes").arg(_expandedNodes));
+                QTimer::singleShot(3000, _expandProgress, SLOT(hide()));
+                return;
+            }
+
+            // Indexes of removed nodes become invalid
+            QModelIndex index = _expandQueue.back();
+            _expandQueue.pop_back();
+            if (!index.isValid())
+                continue;
+
+            // Children are populated by model when node is expanded
             BaseClass::expand(index);
+            ++_expandedNodes;
+
             BsonTreeItem *item = QtUtils::item<BsonTreeItem*>(index);
-            for (unsigned i = 0; i < item->childrenCount(); ++i) {
+            if (!item)
+                continue;
+
+            // Children are pushed in reverse order, so the first child is expanded first
+            for (int i = static_cast<int>(item->childrenCount()) - 1; i >= 0; --i) {
                 BsonTreeItem *tritem = item->child(i);
                 if (tritem && detail::isDocumentType(tritem)) {
-                    expandNode(model()->index(i, 0, index));
+                    _expandQueue.push_back(QPersistentModelIndex(model()->index(i, 0, index)));
                 }
             }
         }
+
+        if (_expandQueue.empty())
+            _expandTimer->stop();
+
+        updateExpandProgress();
+    }
+
+    void BsonTreeView::cancelExpand()
+    {
+        _expandQueue.clear();
+        _expandTimer->stop();
+        updateExpandProgress();
+    }
+
+    bool BsonTreeView::isExpandingRecursively() const
+    {
+        return _expandTimer->isActive();
+    }
+
+    void BsonTreeView::updateExpandProgress()
+    {
+        if (!_expandTimer->isActive()) {
+            _expandProgress->hide();
+            return;
+        }
+
+        showExpandProgress(QString("Expanding... %1 nodes (Esc to cancel)").arg(_expandedNodes));
+    }
+
+    void BsonTreeView::showExpandProgress(const QString &text)
+    {
+        _expandProgress->setText(text);
+        _expandProgress->adjustSize();
+
+        // Bottom-right corner of viewport
+        QRect area = viewport()->geometry();
+        _expandProgress->move(area.right() - _expandProgress->width() - 4, area.bottom() - _expandProgress->height() - 4);
+        _expandProgress->show();
+        _expandProgress->raise();
     }
     
     void BsonTreeView::collapseNode(const QModelIndex &index)
@@ -133,6 +234,30 @@ namespace Robomongo
         }
     }
 
+    void BsonTreeView::showPath(const BsonPath &path)
+    {
+        QAbstractItemModel *itemModel = model();
+        if (!itemModel || path.empty())
+            return;
+
+        // Top-level rows are added to the model in batches
+        while (itemModel->rowCount() <= path[0] && itemModel->canFetchMore(QModelIndex()))
+            itemModel->fetchMore(QModelIndex());
+
+        QModelIndex index = itemModel->index(path[0], 0);
+        for (size_t i = 1; i < path.size() && index.isValid(); ++i) {
+            if (itemModel->canFetchMore(index))
+                itemModel->fetchMore(index);
+            BaseClass::expand(index);
+            index = itemModel->index(path[i], 0, index);
+        }
+
+        if (index.isValid()) {
+            setCurrentIndex(index);
+            scrollTo(index);
+        }
+    }
+
     void BsonTreeView::onExpandRecursive()
     {
         QModelIndexList indexes = selectedIndexes();
@@ -146,6 +271,8 @@ namespace Robomongo
 
     void BsonTreeView::onCollapseRecursive()
     {
+        cancelExpand();
+
         QModelIndexList indexes = selectedIndexes();
         if (detail::isMultiSelection(indexes)) {
             for (int i = 0; i<indexes.count(); ++i)
@@ -1,8 +1,15 @@
 #pragma once
 
 #include <QTreeView>
+#include <vector>
 
 #include "robomongo/core/domain/Notifier.h"
+#include "robomongo/gui/widgets/workarea/BsonSearchThread.h"
+
+QT_BEGIN_NAMESPACE
+class QLabel;
+class QTimer;
+QT_END_NAMESPACE
 
 namespace Robomongo
 {
@@ -14,15 +21,36 @@ namespace Robomongo
 
     public:
         typedef QTreeView BaseClass;
+        enum { expandSliceMs = 10 };            // time of one expansion step in event loop
+        enum { maxExpandedNodes = 20000 };      // recursive expansion stops at this number of nodes
+
         BsonTreeView(MongoShell *shell, const MongoQueryInfo &queryInfo, QWidget *parent = NULL);
         virtual QModelIndex selectedIndex() const;
         virtual QModelIndexList selectedIndexes() const;
+        /**
+         * @brief Expands subtree of 'index' recursively. Nodes are expanded in time slices,
+         * so UI stays responsive; expansion is cancelled by Escape.
+         */
         void expandNode(const QModelIndex &index);
+        void cancelExpand();
+        bool isExpandingRecursively() const;
         void collapseNode(const QModelIndex &index);
+
+        /**
+         * @brief Selects element at 'path', expanding only its ancestors
+         */
+        void showPath(const BsonPath &path);
+
+    Q_SIGNALS:
+        /**
+         * @brief User asked to save documents of result to file
+         */
+        void saveResultRequested();
         
     private Q_SLOTS:
         void onExpandRecursive();
         void onCollapseRecursive();
+        void expandStep();
         void showContextMenu(const QPoint &point);
 
     protected:
@@ -30,8 +58,17 @@ namespace Robomongo
         virtual void keyPressEvent(QKeyEvent *event);
         
     private:
+        void updateExpandProgress();
+        void showExpandProgress(const QString &text);
+
         Notifier _notifier;
         QAction *_expandRecursive;
         QAction *_collapseRecursive;
+        QAction *_saveResult;
+
+        std::vector<QPersistentModelIndex> _expandQueue;   // nodes waiting for expansion, last is next
+        int _expandedNodes;
+        QTimer *_expandTimer;
+        QLabel *_expandProgress;
     };
 }
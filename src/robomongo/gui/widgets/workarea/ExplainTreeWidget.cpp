@@ -0,0 +1,205 @@
+#include "robomongo/gui/widgets/workarea/ExplainTreeWidget.h"
+
+#include <QHeaderView>
+#include <QBrush>
+#include <vector>
+
+#include <mongo/db/jsobj.h>
+
+#include "robomongo/core/utils/QtUtils.h"
+
+namespace
+{
+    enum Columns
+    {
+        StageColumn,
+        ReturnedColumn,
+        DocsExaminedColumn,
+        KeysExaminedColumn,
+        TimeColumn,
+        RatioColumn,
+        ColumnsCount
+    };
+
+    QString prepareValue(const QString &data)
+    {
+        return data + "     "; // ugly yet simple way to extend size of columns
+    }
+
+    QString numberField(const mongo::BSONObj &obj, const char *name)
+    {
+        mongo::BSONElement elem = obj.getField(name);
+        if (!elem.isNumber())
+            return QString();
+
+        return QString::number(elem.numberLong());
+    }
+
+    /**
+     * @brief Ratio of examined documents (or keys, when no documents were fetched)
+     * to returned documents. Values much greater than 1 mean that index is not selective.
+     */
+    QString examinedRatio(const mongo::BSONObj &obj, const char *docsField, const char *keysField)
+    {
+        mongo::BSONElement returned = obj.getField("nReturned");
+        mongo::BSONElement examined = obj.getField(docsField);
+        if (!examined.isNumber() || examined.numberLong() == 0)
+            examined = obj.getField(keysField);
+
+        if (!returned.isNumber() || !examined.isNumber())
+            return QString();
+
+        long long nReturned = returned.numberLong();
+        long long nExamined = examined.numberLong();
+        if (nReturned == 0)
+            return nExamined == 0 ? QString("0") : QString::fromUtf8("\xE2\x88\x9E"); // infinity sign
+
+        return QString::number(static_cast<double>(nExamined) / nReturned, 'f', 2);
+    }
+
+    /**
+     * @brief Child stages are stored in "inputStage", "inputStages" or, for sharded
+     * collections, in "shards[].executionStages".
+     */
+    std::vector<mongo::BSONObj> childStages(const mongo::BSONObj &stage)
+    {
+        std::vector<mongo::BSONObj> children;
+
+        mongo::BSONElement input = stage.getField("inputStage");
+        if (input.type() == mongo::Object)
+            children.push_back(input.Obj());
+
+        const char *arrays[] = { "inputStages", "shards" };
+        for (size_t i = 0; i < sizeof(arrays) / sizeof(arrays[0]); ++i) {
+            mongo::BSONElement list = stage.getField(arrays[i]);
+            if (list.type() != mongo::Array)
+                continue;
+
+            mongo::BSONObjIterator it(list.Obj());
+            while (it.more()) {
+                mongo::BSONElement child = it.next();
+                if (child.type() != mongo::Object)
+                    continue;
+
+                mongo::BSONObj childObj = child.Obj();
+                mongo::BSONElement shardStages = childObj.getField("executionStages");
+                if (shardStages.type() != mongo::Object)
+                    shardStages = childObj.getField("winningPlan");
+
+                children.push_back(shardStages.type() == mongo::Object ? shardStages.Obj() : childObj);
+            }
+        }
+
+        return children;
+    }
+}
+
+namespace Robomongo
+{
+    ExplainTreeWidget::ExplainTreeWidget(QWidget *parent)
+        : QTreeWidget(parent)
+    {
+        QStringList colums;
+        colums << "Stage" << "Returned" << "Docs Examined" << "Keys Examined" << "Time (ms)" << "Examined / Returned";
+        setHeaderLabels(colums);
+
+        setStyleSheet(
+            "QTreeWidget { border-left: 1px solid #c7c5c4; border-top: 1px solid #c7c5c4; }"
+        );
+
+        showLoading();
+    }
+
+    void ExplainTreeWidget::showLoading()
+    {
+        clear();
+        addMessage("Loading...");
+    }
+
+    void ExplainTreeWidget::showError(const QString &message)
+    {
+        clear();
+        addMessage(message);
+    }
+
+    void ExplainTreeWidget::setExplain(const mongo::BSONObj &explain)
+    {
+        clear();
+
+        mongo::BSONObj stats = explain.getObjectField("executionStats");
+        mongo::BSONObj stages = stats.getObjectField("executionStages");
+
+        // Server did not return execution statistics, show winning plan only
+        if (stages.isEmpty())
+            stages = explain.getObjectField("queryPlanner").getObjectField("winningPlan");
+
+        if (stages.isEmpty()) {
+            addMessage("Explain output does not contain query plan");
+            return;
+        }
+
+        QTreeWidgetItem *root = createStageItem(stages);
+
+        if (!stats.isEmpty()) {
+            QTreeWidgetItem *total = new QTreeWidgetItem;
+            total->setText(StageColumn, prepareValue("Total"));
+            total->setText(ReturnedColumn, prepareValue(numberField(stats, "nReturned")));
+            total->setText(DocsExaminedColumn, prepareValue(numberField(stats, "totalDocsExamined")));
+            total->setText(KeysExaminedColumn, prepareValue(numberField(stats, "totalKeysExamined")));
+            total->setText(TimeColumn, prepareValue(numberField(stats, "executionTimeMillis")));
+            total->setText(RatioColumn, prepareValue(examinedRatio(stats, "totalDocsExamined", "totalKeysExamined")));
+
+            QFont font = total->font(StageColumn);
+            font.setBold(true);
+            for (int i = 0; i < ColumnsCount; ++i)
+                total->setFont(i, font);
+
+            total->addChild(root);
+            addTopLevelItem(total);
+        }
+        else {
+            addTopLevelItem(root);
+        }
+
+        expandAll();
+        header()->resizeSections(QHeaderView::ResizeToContents);
+    }
+
+    QTreeWidgetItem *ExplainTreeWidget::createStageItem(const mongo::BSONObj &stage)
+    {
+        QString name = QtUtils::toQString(stage.getStringField("stage"));
+        QString details;
+        if (stage.hasField("indexName"))
+            details = QtUtils::toQString(stage.getStringField("indexName"));
+        else if (stage.hasField("shardName"))
+            details = QtUtils::toQString(stage.getStringField("shardName"));
+
+        QTreeWidgetItem *item = new QTreeWidgetItem;
+        item->setText(StageColumn, prepareValue(details.isEmpty() ? name : QString("%1 (%2)").arg(name).arg(details)));
+        item->setText(ReturnedColumn, prepareValue(numberField(stage, "nReturned")));
+        item->setText(DocsExaminedColumn, prepareValue(numberField(stage, "docsExamined")));
+        item->setText(KeysExaminedColumn, prepareValue(numberField(stage, "keysExamined")));
+        item->setText(TimeColumn, prepareValue(numberField(stage, "executionTimeMillisEstimate")));
+        item->setText(RatioColumn, prepareValue(examinedRatio(stage, "docsExamined", "keysExamined")));
+
+        // Full collection scans and blocking in-memory sorts usually mean that index is missing
+        if (name == "COLLSCAN" || name == "SORT") {
+            item->setToolTip(StageColumn, name == "COLLSCAN" ? "Full collection scan" : "In-memory sort");
+            for (int i = 0; i < ColumnsCount; ++i)
+                item->setBackground(i, QBrush("#f9d6d5"));
+        }
+
+        std::vector<mongo::BSONObj> children = childStages(stage);
+        for (size_t i = 0; i < children.size(); ++i)
+            item->addChild(createStageItem(children[i]));
+
+        return item;
+    }
+
+    void ExplainTreeWidget::addMessage(const QString &message)
+    {
+        QTreeWidgetItem *item = new QTreeWidgetItem;
+        item->setText(StageColumn, message);
+        addTopLevelItem(item);
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <QTreeWidget>
+
+#include <mongo/bson/bsonobj.h>
+
+QT_BEGIN_NAMESPACE
+class QTreeWidgetItem;
+QT_END_NAMESPACE
+
+namespace Robomongo
+{
+    /**
+     * @brief Renders output of explain("executionStats") as a tree of execution stages.
+     * COLLSCAN and in-memory SORT stages are highlighted.
+     */
+    class ExplainTreeWidget : public QTreeWidget
+    {
+        Q_OBJECT
+    public:
+        ExplainTreeWidget(QWidget *parent = NULL);
+
+        void showLoading();
+        void showError(const QString &message);
+        void setExplain(const mongo::BSONObj &explain);
+
+    private:
+        QTreeWidgetItem *createStageItem(const mongo::BSONObj &stage);
+        void addMessage(const QString &message);
+    };
+}
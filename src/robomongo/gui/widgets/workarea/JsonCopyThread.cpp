@@ -0,0 +1,86 @@
+#include "robomongo/gui/widgets/workarea/JsonCopyThread.h"
+
+#include <algorithm>
+#include <limits>
+#include <string>
+
+#include "robomongo/core/utils/BsonUtils.h"
+
+namespace Robomongo
+{
+    JsonCopyThread::JsonCopyThread(const std::vector<mongo::BSONObj> &documents, bool isArray, UUIDEncoding uuidEncoding,
+                                   SupportedTimes timeZone, const ResultWriterPtr &writer) :
+        _documents(documents),
+        _isArray(isArray),
+        _uuidEncoding(uuidEncoding),
+        _timeZone(timeZone),
+        _writer(writer),
+        _stop(false)
+    {
+    }
+
+    void JsonCopyThread::stop()
+    {
+        _stop = true;
+        if (_writer)
+            _writer->cancel();
+    }
+
+    size_t JsonCopyThread::estimatedSize(const std::vector<mongo::BSONObj> &documents)
+    {
+        size_t size = 0;
+        for (size_t i = 0; i < documents.size(); ++i)
+            size += documents[i].objsize();
+        return size * 2;
+    }
+
+    void JsonCopyThread::run()
+    {
+        if (_writer)
+            return writeToFile();
+
+        const size_t count = _documents.size();
+        const bool asArray = count > 1;
+
+        // Text is reserved once and is the only copy of whole JSON, each document
+        // is formatted into reused buffer and appended
+        QByteArray json;
+        json.reserve(static_cast<int>(std::min<size_t>(estimatedSize(_documents) + count * 2 + 4,
+                                                        std::numeric_limits<int>::max())));
+        std::string buffer;
+        if (asArray)
+            json.append("[\n");
+
+        for (size_t i = 0; i < count; ++i) {
+            if (_stop)
+                return;
+
+            if (i > 0)
+                json.append(",\n");
+            buffer.clear();
+            BsonUtils::writeJson(buffer, _documents[i], BsonUtils::TenGenJson, 1, _uuidEncoding, _timeZone, _isArray && !asArray);
+            json.append(buffer.data(), static_cast<int>(buffer.size()));
+
+            if ((i + 1) % progressStep == 0)
+                emit progress(static_cast<int>(i + 1));
+        }
+
+        if (asArray)
+            json.append("\n]");
+
+        _result = json;
+    }
+
+    void JsonCopyThread::writeToFile()
+    {
+        for (size_t i = 0; i < _documents.size(); ++i) {
+            if (!_writer->write(_documents[i]))
+                break;
+
+            if ((i + 1) % progressStep == 0)
+                emit progress(static_cast<int>(i + 1));
+        }
+
+        _writer->close();
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <QByteArray>
+#include <QThread>
+#include <vector>
+#include <mongo/bson/bsonobj.h>
+
+#include "robomongo/core/Enums.h"
+#include "robomongo/core/domain/ResultWriter.h"
+
+namespace Robomongo
+{
+    /*
+    ** In this thread we are formatting selected documents for "Copy JSON",
+    ** into one pre-sized UTF-8 buffer, or into file when writer is given
+    */
+    class JsonCopyThread : public QThread
+    {
+        Q_OBJECT
+
+    public:
+        enum { progressStep = 256 };    // documents
+
+        /**
+         * @brief One document is copied as is ('isArray' when it is array value),
+         * several documents are copied as array
+         */
+        JsonCopyThread(const std::vector<mongo::BSONObj> &documents, bool isArray, UUIDEncoding uuidEncoding,
+                       SupportedTimes timeZone, const ResultWriterPtr &writer = ResultWriterPtr());
+        void stop();
+        bool isStopped() const { return _stop; }
+
+        /**
+         * @brief JSON text in UTF-8, available after thread is finished (empty if stopped
+         * or written to file). It is put to clipboard as is, without conversion to QString.
+         */
+        const QByteArray &result() const { return _result; }
+        ResultWriterPtr writer() const { return _writer; }
+
+        /**
+         * @brief Expected size of JSON of documents in bytes, pretty JSON is
+         * about twice as large as BSON
+         */
+        static size_t estimatedSize(const std::vector<mongo::BSONObj> &documents);
+
+    Q_SIGNALS:
+        /**
+         * @brief Signals number of formatted documents
+         */
+        void progress(int processed);
+
+    protected:
+        virtual void run();
+
+    private:
+        void writeToFile();
+
+        const std::vector<mongo::BSONObj> _documents;
+        const bool _isArray;
+        const UUIDEncoding _uuidEncoding;
+        const SupportedTimes _timeZone;
+        const ResultWriterPtr _writer;
+        QByteArray _result;
+        volatile bool _stop;
+    };
+}
@@ -1,10 +1,40 @@
 #include "robomongo/gui/widgets/workarea/JsonPrepareThread.h"
 
-#include <QHBoxLayout>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThreadPool>
+#include <algorithm>
+#include <functional>
+#include <string>
 
 #include "robomongo/core/domain/MongoDocument.h"
 #include "robomongo/core/utils/BsonUtils.h"
 #include "robomongo/core/utils/QtUtils.h"
+#include "robomongo/core/utils/StdUtils.h"
+
+namespace
+{
+    const size_t minChunk = 16; // documents formatted by one thread at least
+
+    /**
+     * @brief Part of block formatted in pool thread, releases semaphore when finished
+     */
+    class FormatTask : public QRunnable
+    {
+    public:
+        FormatTask(const std::function<void()> &func, QSemaphore &finished) : _func(func), _finished(finished) {}
+
+        virtual void run()
+        {
+            _func();
+            _finished.release();
+        }
+
+    private:
+        const std::function<void()> _func;
+        QSemaphore &_finished;
+    };
+}
 
 namespace Robomongo
 {
@@ -23,33 +53,55 @@ namespace Robomongo
 
     void JsonPrepareThread::run()
     {
-        int position = 1; // 1-based numbering to match tree & table views
-        for (std::vector<MongoDocumentPtr>::const_iterator it = _bsonObjects.begin(); it != _bsonObjects.end(); ++it)
-        {
-            MongoDocumentPtr doc = *it;
-            mongo::StringBuilder sb;
-            if (position == 1)
-                sb << "/* 1 */\n";
-            else
-                sb << "\n\n/* " << position << " */\n";
+        const size_t count = _bsonObjects.size();
+        std::string part;
 
-            mongo::BSONObj obj = doc->bsonObj();
-            std::string stdJson = BsonUtils::jsonString(obj, mongo::TenGen, 1, _uuidEncoding, _timeZone);
+        // Pool threads are started once and serve all blocks of the run
+        QThreadPool pool;
+        pool.setExpiryTimeout(-1);
+        QSemaphore finishedTasks;
 
-            if (_stop)
-                break;
+        for (size_t first = 0; first < count; first += blockSize) {
+            const size_t blockCount = std::min<size_t>(blockSize, count - first);
+            std::vector<std::string> jsons(blockCount);
 
-            sb << stdJson;
-            QString json = QtUtils::toQString(sb.str());
+            auto format = [&, first](size_t begin, size_t end) {
+                for (size_t i = begin; i < end && !_stop; ++i) {
+                    const size_t position = first + i + 1; // 1-based numbering to match tree & table views
+                    std::string &json = jsons[i];
+                    json = position == 1 ? "/* 1 */\n" : "\n\n/* " + std::to_string(position) + " */\n";
+                    BsonUtils::writeJson(json, _bsonObjects[first + i]->bsonObj(), BsonUtils::TenGenJson, 1, _uuidEncoding, _timeZone);
+                }
+            };
 
-            if (_stop)
-                break;
+            // Documents of block are formatted in parallel, each into its own string.
+            // First chunk is formatted by this thread, the rest by pool.
+            const size_t threads = stdutils::parallelThreads(blockCount, minChunk);
+            const size_t chunk = (blockCount + threads - 1) / threads;
+            int tasks = 0;
+            for (size_t begin = chunk; begin < blockCount; begin += chunk, ++tasks) {
+                const size_t end = std::min(blockCount, begin + chunk);
+                pool.start(new FormatTask([&format, begin, end]() { format(begin, end); }, finishedTasks));
+            }
+            format(0, std::min(blockCount, chunk));
+            finishedTasks.acquire(tasks);
 
-            emit partReady(json);
+            if (_stop)
+                return;
 
-            position++;
+            // ...and are reassembled in original order
+            for (size_t i = 0; i < blockCount; ++i) {
+                part += jsons[i];
+                if (part.size() >= partSize) {
+                    emit partReady(QtUtils::toQString(part));
+                    part.clear();
+                }
+            }
         }
 
+        if (!part.empty())
+            emit partReady(QtUtils::toQString(part));
+
         emit done();
     }
 }
@@ -17,6 +17,9 @@ namespace Robomongo
         Q_OBJECT
 
     public:
+        enum { blockSize = 256 };               // documents formatted in parallel at once
+        enum { partSize = 256 * 1024 };         // bytes of JSON in one part, appended to editor at once
+
         /*
         ** Constructor
         */
@@ -29,7 +32,8 @@ namespace Robomongo
         void done();
 
         /**
-         * @brief Signals when json part is ready
+         * @brief Signals when json part is ready. Part contains one or more
+         * documents in original order, about 'partSize' bytes.
          */
         void partReady(const QString &part);
 
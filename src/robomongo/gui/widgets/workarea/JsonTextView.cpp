@@ -0,0 +1,506 @@
+#include "robomongo/gui/widgets/workarea/JsonTextView.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <QApplication>
+#include <QCheckBox>
+#include <QClipboard>
+#include <QContextMenuEvent>
+#include <QHBoxLayout>
+#include <QKeyEvent>
+#include <QLineEdit>
+#include <QMenu>
+#include <QMessageBox>
+#include <QPainter>
+#include <QPushButton>
+#include <QScrollBar>
+#include <QVBoxLayout>
+
+#include "robomongo/core/domain/MongoDocument.h"
+#include "robomongo/core/utils/BsonUtils.h"
+#include "robomongo/core/utils/QtUtils.h"
+#include "robomongo/core/utils/StdUtils.h"
+#include "robomongo/gui/GuiRegistry.h"
+#include "robomongo/gui/editors/FindFrame.h"
+#include "robomongo/gui/editors/JsonLexer.h"
+
+namespace
+{
+    const size_t minChunk = 64; // documents counted by one thread at least
+
+    bool isWordCharacter(QChar c)
+    {
+        return c.isLetterOrNumber() || c == '_' || c == '$';
+    }
+}
+
+namespace Robomongo
+{
+    JsonTextArea::JsonTextArea(const std::vector<MongoDocumentPtr> &documents, UUIDEncoding uuidEncoding,
+                               SupportedTimes timeZone, QWidget *parent) :
+        BaseClass(parent),
+        _documents(documents),
+        _uuidEncoding(uuidEncoding),
+        _timeZone(timeZone),
+        _cache(cacheSize),
+        _lexer(new JsonLexer(this)),
+        _maxWidth(0)
+    {
+        setFont(GuiRegistry::instance().font());
+        setFocusPolicy(Qt::StrongFocus);
+        setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
+        setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+        setStyleSheet("QFrame {background-color: rgb(73, 76, 78); border: 1px solid #c7c5c4; border-radius: 0px; margin: 0px; padding: 0px;}");
+        viewport()->setCursor(Qt::IBeamCursor);
+
+        // Lines are counted in parallel from BSON, documents are not formatted
+        const size_t count = _documents.size();
+        std::vector<int> lines(count);
+        stdutils::parallelFor(count, minChunk, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+                lines[i] = (i > 0 ? 1 : 0) + 1 + BsonUtils::jsonLineBreaks(_documents[i]->bsonObj()) + 1;
+        });
+
+        _firstLines.resize(count + 1, 0);
+        for (size_t i = 0; i < count; ++i)
+            _firstLines[i + 1] = _firstLines[i] + lines[i];
+
+        updateScrollBars();
+    }
+
+    JsonTextArea::~JsonTextArea()
+    {
+
+    }
+
+    int JsonTextArea::lineCount() const
+    {
+        return _firstLines.back();
+    }
+
+    QString JsonTextArea::line(int index) const
+    {
+        // Copy, cached lines of document can be evicted by next call
+        const int document = documentOfLine(index);
+        return documentLines(document).value(index - _firstLines[document]);
+    }
+
+    bool JsonTextArea::hasSelection() const
+    {
+        return !(_anchor == _cursor);
+    }
+
+    QString JsonTextArea::selectedText() const
+    {
+        const TextPosition start = std::min(_anchor, _cursor);
+        const TextPosition end = std::max(_anchor, _cursor);
+
+        QString result;
+        for (int i = start._line; i <= end._line; ++i) {
+            const QString text = line(i);
+            const int from = i == start._line ? start._column : 0;
+            if (i == end._line) {
+                result += text.mid(from, end._column - from);
+            }
+            else {
+                result += text.mid(from);
+                result += '\n';
+            }
+        }
+        return result;
+    }
+
+    bool JsonTextArea::find(const QString &text, bool forward, Qt::CaseSensitivity caseSensitivity)
+    {
+        const int count = lineCount();
+        if (text.isEmpty() || count == 0)
+            return false;
+
+        QApplication::setOverrideCursor(Qt::WaitCursor);
+
+        // Line of selection is checked twice: from selection and, after wrap, on its other side
+        const TextPosition start = forward ? std::max(_anchor, _cursor) : std::min(_anchor, _cursor);
+        bool isFound = false;
+        for (int step = 0; step <= count && !isFound; ++step) {
+            const int index = forward ? (start._line + step) % count : ((start._line - step) % count + count) % count;
+            const QString current = line(index);
+
+            int column = -1;
+            if (forward)
+                column = current.indexOf(text, step == 0 ? start._column : 0, caseSensitivity);
+            else if (step > 0)
+                column = current.lastIndexOf(text, -1, caseSensitivity);
+            else if (start._column > 0)
+                column = current.lastIndexOf(text, start._column - 1, caseSensitivity);
+
+            if (column >= 0) {
+                const TextPosition end(index, column + text.size());
+                select(TextPosition(index, column), end);
+                ensureVisible(end);
+                ensureVisible(TextPosition(index, column));
+                isFound = true;
+            }
+        }
+
+        QApplication::restoreOverrideCursor();
+        return isFound;
+    }
+
+    void JsonTextArea::copy()
+    {
+        if (hasSelection())
+            QApplication::clipboard()->setText(selectedText());
+    }
+
+    void JsonTextArea::selectAll()
+    {
+        const int count = lineCount();
+        if (count > 0)
+            select(TextPosition(0, 0), TextPosition(count - 1, line(count - 1).size()));
+    }
+
+    void JsonTextArea::paintEvent(QPaintEvent *event)
+    {
+        QPainter painter(viewport());
+        painter.fillRect(event->rect(), _lexer->defaultPaper(JsonLexer::Default));
+        painter.setFont(font());
+
+        const int height = lineHeight();
+        const int ascent = fontMetrics().ascent();
+        const int first = verticalScrollBar()->value();
+        const int last = std::min(lineCount(), first + visibleLines() + 1);
+        const int x = margin - horizontalScrollBar()->value();
+        const TextPosition start = std::min(_anchor, _cursor);
+        const TextPosition end = std::max(_anchor, _cursor);
+        const bool isSelected = hasSelection();
+
+        int widest = _maxWidth;
+        for (int i = first; i < last; ++i) {
+            const QString text = line(i);
+            const int y = (i - first) * height;
+            const int width = textWidth(text);
+
+            if (isSelected && start._line <= i && i <= end._line) {
+                const int from = i == start._line ? textWidth(text.left(start._column)) : 0;
+                const int to = i == end._line ? textWidth(text.left(end._column)) : width + fontMetrics().width(' ');
+                painter.fillRect(x + from, y, to - from, height, palette().highlight());
+            }
+
+            paintLine(painter, text, x, y + ascent);
+            widest = std::max(widest, width);
+        }
+
+        // Horizontal range grows with lines seen so far, whole text is never measured
+        if (widest > _maxWidth) {
+            _maxWidth = widest;
+            QMetaObject::invokeMethod(this, "updateScrollBars", Qt::QueuedConnection);
+        }
+    }
+
+    void JsonTextArea::resizeEvent(QResizeEvent *event)
+    {
+        BaseClass::resizeEvent(event);
+        updateScrollBars();
+    }
+
+    void JsonTextArea::scrollContentsBy(int dx, int dy)
+    {
+        viewport()->update();
+    }
+
+    void JsonTextArea::keyPressEvent(QKeyEvent *event)
+    {
+        if (event->matches(QKeySequence::Copy)) {
+            copy();
+            return event->accept();
+        }
+        else if (event->matches(QKeySequence::SelectAll)) {
+            selectAll();
+            return event->accept();
+        }
+        else if (event->matches(QKeySequence::MoveToStartOfDocument)) {
+            verticalScrollBar()->setValue(0);
+            return event->accept();
+        }
+        else if (event->matches(QKeySequence::MoveToEndOfDocument)) {
+            verticalScrollBar()->setValue(verticalScrollBar()->maximum());
+            return event->accept();
+        }
+        else if (event->key() == Qt::Key_Home) {
+            horizontalScrollBar()->setValue(0);
+            return event->accept();
+        }
+
+        // Arrows and pages scroll, other keys go to parent (find panel)
+        return BaseClass::keyPressEvent(event);
+    }
+
+    void JsonTextArea::mousePressEvent(QMouseEvent *event)
+    {
+        if (event->button() != Qt::LeftButton)
+            return BaseClass::mousePressEvent(event);
+
+        const TextPosition position = positionAt(event->pos());
+        if (event->modifiers() & Qt::ShiftModifier)
+            select(_anchor, position);
+        else
+            select(position, position);
+    }
+
+    void JsonTextArea::mouseMoveEvent(QMouseEvent *event)
+    {
+        if (!(event->buttons() & Qt::LeftButton))
+            return BaseClass::mouseMoveEvent(event);
+
+        const TextPosition position = positionAt(event->pos());
+        select(_anchor, position);
+        ensureVisible(position);
+    }
+
+    void JsonTextArea::mouseDoubleClickEvent(QMouseEvent *event)
+    {
+        if (event->button() != Qt::LeftButton || lineCount() == 0)
+            return BaseClass::mouseDoubleClickEvent(event);
+
+        const TextPosition position = positionAt(event->pos());
+        const QString text = line(position._line);
+
+        int from = position._column;
+        int to = position._column;
+        while (from > 0 && isWordCharacter(text[from - 1]))
+            --from;
+        while (to < text.size() && isWordCharacter(text[to]))
+            ++to;
+
+        select(TextPosition(position._line, from), TextPosition(position._line, to));
+    }
+
+    void JsonTextArea::contextMenuEvent(QContextMenuEvent *event)
+    {
+        QMenu menu(this);
+        QAction *copyAction = menu.addAction(tr("Copy"), this, SLOT(copy()));
+        copyAction->setShortcut(QKeySequence::Copy);
+        copyAction->setEnabled(hasSelection());
+        QAction *selectAllAction = menu.addAction(tr("Select All"), this, SLOT(selectAll()));
+        selectAllAction->setShortcut(QKeySequence::SelectAll);
+        menu.exec(event->globalPos());
+    }
+
+    void JsonTextArea::updateScrollBars()
+    {
+        const int visible = visibleLines();
+        verticalScrollBar()->setRange(0, std::max(0, lineCount() - visible));
+        verticalScrollBar()->setPageStep(visible);
+        verticalScrollBar()->setSingleStep(1);
+
+        const int width = viewport()->width();
+        horizontalScrollBar()->setRange(0, std::max(0, _maxWidth + 2 * margin - width));
+        horizontalScrollBar()->setPageStep(width);
+        horizontalScrollBar()->setSingleStep(4 * fontMetrics().width(' '));
+    }
+
+    const QStringList &JsonTextArea::documentLines(int document) const
+    {
+        if (QStringList *lines = _cache.object(document))
+            return *lines;
+
+        std::string json = document == 0 ? "/* 1 */\n" : "\n/* " + std::to_string(document + 1) + " */\n";
+        BsonUtils::writeJson(json, _documents[document]->bsonObj(), BsonUtils::TenGenJson, 1, _uuidEncoding, _timeZone);
+        QStringList *lines = new QStringList(QtUtils::toQString(json).split('\n'));
+
+        // Lines of next documents are found by index, so text has to agree with it
+        const int count = _firstLines[document + 1] - _firstLines[document];
+        while (lines->size() < count)
+            lines->append(QString());
+        while (lines->size() > count) {
+            const QString last = lines->takeLast();
+            lines->last() += ' ' + last;
+        }
+
+        _cache.insert(document, lines, std::min<size_t>(json.size() + 1, cacheSize));
+        return *lines;
+    }
+
+    int JsonTextArea::documentOfLine(int line) const
+    {
+        return std::upper_bound(_firstLines.begin(), _firstLines.end(), line) - _firstLines.begin() - 1;
+    }
+
+    TextPosition JsonTextArea::positionAt(const QPoint &point) const
+    {
+        const int count = lineCount();
+        if (count == 0)
+            return TextPosition();
+
+        const int row = verticalScrollBar()->value() + static_cast<int>(std::floor(point.y() / double(lineHeight())));
+        const int index = std::max(0, std::min(count - 1, row));
+        const QString text = line(index);
+        const int x = point.x() - margin + horizontalScrollBar()->value();
+
+        // Character is taken when its middle is left of point
+        const QFontMetrics metrics = fontMetrics();
+        const int length = std::min<int>(text.size(), maxPaintedLength);
+        int column = 0;
+        for (int width = 0; column < length; ++column) {
+            const int charWidth = metrics.width(text[column]);
+            if (width + charWidth / 2 > x)
+                break;
+            width += charWidth;
+        }
+        return TextPosition(index, column);
+    }
+
+    void JsonTextArea::select(const TextPosition &anchor, const TextPosition &cursor)
+    {
+        _anchor = anchor;
+        _cursor = cursor;
+        viewport()->update();
+    }
+
+    void JsonTextArea::ensureVisible(const TextPosition &position)
+    {
+        const int first = verticalScrollBar()->value();
+        const int visible = std::max(1, visibleLines());
+        if (position._line < first)
+            verticalScrollBar()->setValue(position._line);
+        else if (position._line >= first + visible)
+            verticalScrollBar()->setValue(position._line - visible + 1);
+
+        // Line may be not painted yet, horizontal range has to include it
+        const QString text = line(position._line);
+        const int lineWidth = textWidth(text);
+        if (lineWidth > _maxWidth) {
+            _maxWidth = lineWidth;
+            updateScrollBars();
+        }
+
+        const int x = textWidth(text.left(position._column));
+        const int left = horizontalScrollBar()->value();
+        const int width = viewport()->width() - 2 * margin;
+        if (x < left)
+            horizontalScrollBar()->setValue(x);
+        else if (x > left + width)
+            horizontalScrollBar()->setValue(x - width);
+    }
+
+    int JsonTextArea::lineHeight() const
+    {
+        return fontMetrics().lineSpacing();
+    }
+
+    int JsonTextArea::visibleLines() const
+    {
+        return viewport()->height() / lineHeight();
+    }
+
+    int JsonTextArea::textWidth(const QString &text) const
+    {
+        return fontMetrics().width(text.left(maxPaintedLength));
+    }
+
+    void JsonTextArea::paintLine(QPainter &painter, const QString &text, int x, int y) const
+    {
+        const QFontMetrics metrics = fontMetrics();
+        const int right = viewport()->width();
+        const int length = std::min<int>(text.size(), maxPaintedLength);
+
+        // Lines are styled by the same lexer as text mode, each from default state
+        std::vector<unsigned char> styles(length);
+        JsonLexer::scan(text.constData(), length, JsonLexer::StateDefault, styles.data());
+
+        for (int i = 0; i < length && x < right;) {
+            int next = i + 1;
+            while (next < length && styles[next] == styles[i])
+                ++next;
+
+            const QString token = text.mid(i, next - i);
+            painter.setPen(_lexer->defaultColor(styles[i]));
+            painter.drawText(x, y, token);
+            x += metrics.width(token);
+            i = next;
+        }
+
+        if (length < text.size() && x < right) {
+            painter.setPen(_lexer->defaultColor(JsonLexer::Comment));
+            painter.drawText(x, y, " ...");
+        }
+    }
+
+    JsonTextView::JsonTextView(const std::vector<MongoDocumentPtr> &documents, UUIDEncoding uuidEncoding,
+                               SupportedTimes timeZone, QWidget *parent) :
+        BaseClass(parent),
+        _text(new JsonTextArea(documents, uuidEncoding, timeZone, this)),
+        _findPanel(new QFrame(this)),
+        _findLine(new QLineEdit(this)),
+        _next(new QPushButton("Next", this)),
+        _prev(new QPushButton("Previous", this)),
+        _caseSensitive(new QCheckBox("Match case", this))
+    {
+        _findLine->setAlignment(Qt::AlignLeft | Qt::AlignAbsolute);
+
+        QHBoxLayout *layout = new QHBoxLayout();
+        layout->setContentsMargins(2, 0, 6, 0);
+        layout->setSpacing(7);
+        layout->addWidget(_findLine);
+        layout->addWidget(_next);
+        layout->addWidget(_prev);
+        layout->addWidget(_caseSensitive);
+
+        _findPanel->setFixedHeight(FindFrame::HeightFindPanel);
+        _findPanel->setLayout(layout);
+
+        QVBoxLayout *mainLayout = new QVBoxLayout();
+        mainLayout->setContentsMargins(0, 0, 0, 0);
+        mainLayout->setSpacing(0);
+        mainLayout->addWidget(_text, 1);
+        mainLayout->addWidget(_findPanel, 0, Qt::AlignBottom);
+        setLayout(mainLayout);
+
+        _findPanel->hide();
+
+        VERIFY(connect(_next, SIGNAL(clicked()), this, SLOT(goToNextElement())));
+        VERIFY(connect(_prev, SIGNAL(clicked()), this, SLOT(goToPrevElement())));
+    }
+
+    void JsonTextView::keyPressEvent(QKeyEvent *keyEvent)
+    {
+        bool isShowFind = _findPanel->isVisible();
+        if (Qt::Key_Escape == keyEvent->key() && isShowFind) {
+            _findPanel->hide();
+            _text->setFocus();
+            return keyEvent->accept();
+        } else if ((Qt::Key_Return == keyEvent->key() || Qt::Key_Enter == keyEvent->key()) && isShowFind) {
+            findElement(!(keyEvent->modifiers() & Qt::ShiftModifier));
+            return keyEvent->accept();
+        } else if ((keyEvent->modifiers() & Qt::ControlModifier) && keyEvent->key() == Qt::Key_F) {
+            _findPanel->show();
+            _findLine->setFocus();
+            _findLine->selectAll();
+            return keyEvent->accept();
+        }
+
+        return BaseClass::keyPressEvent(keyEvent);
+    }
+
+    void JsonTextView::goToNextElement()
+    {
+        findElement(true);
+    }
+
+    void JsonTextView::goToPrevElement()
+    {
+        findElement(false);
+    }
+
+    void JsonTextView::findElement(bool forward)
+    {
+        const QString &text = _findLine->text();
+        if (text.isEmpty())
+            return;
+
+        Qt::CaseSensitivity caseSensitivity = _caseSensitive->checkState() == Qt::Checked ? Qt::CaseSensitive : Qt::CaseInsensitive;
+        if (!_text->find(text, forward, caseSensitivity))
+            QMessageBox::warning(this, tr("Search"), tr("The specified text was not found."));
+    }
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <QAbstractScrollArea>
+#include <QCache>
+#include <QFrame>
+#include <QStringList>
+#include <vector>
+
+#include "robomongo/core/Core.h"
+#include "robomongo/core/Enums.h"
+
+QT_BEGIN_NAMESPACE
+class QLineEdit;
+class QPushButton;
+class QCheckBox;
+QT_END_NAMESPACE
+
+namespace Robomongo
+{
+    class JsonLexer;
+
+    /**
+     * @brief Position in text: line and character in line
+     */
+    struct TextPosition
+    {
+        TextPosition(int line = 0, int column = 0) : _line(line), _column(column) {}
+
+        bool operator<(const TextPosition &other) const
+        {
+            return _line < other._line || (_line == other._line && _column < other._column);
+        }
+
+        bool operator==(const TextPosition &other) const
+        {
+            return _line == other._line && _column == other._column;
+        }
+
+        int _line;
+        int _column;
+    };
+
+    /**
+     * @brief Read-only JSON of documents, laid out the same way as text mode of results.
+     * Only line index is kept: lines of every document are counted from BSON without
+     * formatting, text of documents in viewport is formatted on demand and cached.
+     */
+    class JsonTextArea : public QAbstractScrollArea
+    {
+        Q_OBJECT
+
+    public:
+        typedef QAbstractScrollArea BaseClass;
+        enum { cacheSize = 4 * 1024 * 1024 };   // characters of formatted documents kept in cache
+        enum { maxPaintedLength = 16 * 1024 };  // characters of long lines that are painted
+        enum { margin = 4 };
+
+        JsonTextArea(const std::vector<MongoDocumentPtr> &documents, UUIDEncoding uuidEncoding,
+                     SupportedTimes timeZone, QWidget *parent = NULL);
+        ~JsonTextArea();
+
+        int lineCount() const;
+        QString line(int index) const;
+
+        bool hasSelection() const;
+        QString selectedText() const;
+
+        /**
+         * @brief Finds next (or previous) occurrence of 'text' from current selection,
+         * wraps around the end. Documents are formatted one by one while searching.
+         */
+        bool find(const QString &text, bool forward, Qt::CaseSensitivity caseSensitivity);
+
+    public Q_SLOTS:
+        void copy();
+        void selectAll();
+
+    protected:
+        virtual void paintEvent(QPaintEvent *event);
+        virtual void resizeEvent(QResizeEvent *event);
+        virtual void scrollContentsBy(int dx, int dy);
+        virtual void keyPressEvent(QKeyEvent *event);
+        virtual void mousePressEvent(QMouseEvent *event);
+        virtual void mouseMoveEvent(QMouseEvent *event);
+        virtual void mouseDoubleClickEvent(QMouseEvent *event);
+        virtual void contextMenuEvent(QContextMenuEvent *event);
+
+    private Q_SLOTS:
+        void updateScrollBars();
+
+    private:
+        /**
+         * @brief Lines of document: blank line between documents, comment with number of document and JSON
+         */
+        const QStringList &documentLines(int document) const;
+        int documentOfLine(int line) const;
+
+        TextPosition positionAt(const QPoint &point) const;
+        void select(const TextPosition &anchor, const TextPosition &cursor);
+        void ensureVisible(const TextPosition &position);
+        int lineHeight() const;
+        int visibleLines() const;
+        int textWidth(const QString &text) const;
+        void paintLine(QPainter &painter, const QString &text, int x, int y) const;
+
+        const std::vector<MongoDocumentPtr> _documents;
+        const UUIDEncoding _uuidEncoding;
+        const SupportedTimes _timeZone;
+
+        std::vector<int> _firstLines;           // first line of every document and total count of lines
+        mutable QCache<int, QStringList> _cache;
+        JsonLexer *_lexer;                      // styles and colors of text, same as in text mode
+
+        TextPosition _anchor;                   // selection is between anchor and cursor
+        TextPosition _cursor;
+        mutable int _maxWidth;                  // widest line painted so far
+    };
+
+    /**
+     * @brief JsonTextArea with find panel, same as FindFrame of text mode
+     */
+    class JsonTextView : public QFrame
+    {
+        Q_OBJECT
+
+    public:
+        typedef QFrame BaseClass;
+
+        JsonTextView(const std::vector<MongoDocumentPtr> &documents, UUIDEncoding uuidEncoding,
+                     SupportedTimes timeZone, QWidget *parent = NULL);
+
+        JsonTextArea *textArea() const { return _text; }
+
+    protected:
+        virtual void keyPressEvent(QKeyEvent *event);
+
+    private Q_SLOTS:
+        void goToNextElement();
+        void goToPrevElement();
+
+    private:
+        void findElement(bool forward);
+
+        JsonTextArea *_text;
+        QFrame *_findPanel;
+        QLineEdit *_findLine;
+        QPushButton *_next;
+        QPushButton *_prev;
+        QCheckBox *_caseSensitive;
+    };
+}
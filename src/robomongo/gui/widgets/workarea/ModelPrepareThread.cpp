@@ -0,0 +1,117 @@
+#include "robomongo/gui/widgets/workarea/ModelPrepareThread.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <mongo/client/dbclientinterface.h>
+
+#include "robomongo/core/domain/MongoDocument.h"
+#include "robomongo/core/utils/QtUtils.h"
+
+namespace Robomongo
+{
+    int BsonTableLayout::field(int row, int column) const
+    {
+        const BsonTableCell *begin = _cells.data() + _rowStarts[row];
+        const BsonTableCell *end = _cells.data() + _rowStarts[row + 1];
+        const BsonTableCell *cell = std::lower_bound(begin, end, column, [](const BsonTableCell &cell, int column) {
+            return cell._column < column;
+        });
+        return cell != end && cell->_column == column ? cell->_field : -1;
+    }
+
+    int BsonTableLayout::column(int row, int field) const
+    {
+        for (size_t i = _rowStarts[row]; i < _rowStarts[row + 1]; ++i) {
+            if (_cells[i]._field == field)
+                return _cells[i]._column;
+        }
+        return -1;
+    }
+
+    ModelPrepareThread::ModelPrepareThread(const std::vector<MongoDocumentPtr> &documents, bool truncatedValues)
+        :_bsonObjects(documents),
+        _truncatedValues(truncatedValues),
+        _stop(false)
+    {
+    }
+
+    void ModelPrepareThread::stop()
+    {
+        _stop = true;
+    }
+
+    void ModelPrepareThread::run()
+    {
+        std::shared_ptr<PreparedDocuments> prepared = std::make_shared<PreparedDocuments>();
+        prepared->_truncatedValues = _truncatedValues;
+        prepared->_documents.reserve(_bsonObjects.size());
+        for (std::vector<MongoDocumentPtr>::const_iterator it = _bsonObjects.begin(); it != _bsonObjects.end(); ++it)
+            prepared->_documents.push_back((*it)->bsonObj());
+
+        if (!buildLayout(*prepared))
+            return;
+
+        _result = prepared;
+    }
+
+    bool ModelPrepareThread::buildLayout(PreparedDocuments &prepared)
+    {
+        const std::vector<mongo::BSONObj> &documents = prepared._documents;
+        BsonTableLayout &layout = prepared._layout;
+
+        std::unordered_map<std::string, int> columns;
+        std::vector<std::string> names;
+        std::vector<BsonTableCell> &cells = layout._cells;
+        std::vector<size_t> &rowStarts = layout._rowStarts;
+        rowStarts.reserve(documents.size() + 1);
+
+        for (size_t row = 0; row < documents.size(); ++row) {
+            if (_stop)
+                return false;
+
+            if (row % progressStep == 0)
+                emit progress(row);
+
+            const mongo::BSONObj &doc = documents[row];
+            const bool isArray = doc.isArray();
+            const size_t rowStart = cells.size();
+            rowStarts.push_back(rowStart);
+
+            mongo::BSONObjIterator iterator(doc);
+            for (int field = 0; iterator.more(); ++field) {
+                mongo::BSONElement element = iterator.next();
+                std::string name = element.fieldName();
+
+                // Same keys as in tree view
+                if (isArray)
+                    name = "[" + name + "]";
+
+                std::unordered_map<std::string, int>::const_iterator column = columns.find(name);
+                if (column == columns.end()) {
+                    column = columns.insert(std::make_pair(name, static_cast<int>(names.size()))).first;
+                    names.push_back(name);
+                }
+
+                BsonTableCell cell = { column->second, field };
+                cells.push_back(cell);
+            }
+
+            // Fields are mostly in order of columns already. When field is duplicated, first one is shown.
+            std::stable_sort(cells.begin() + rowStart, cells.end(), [](const BsonTableCell &a, const BsonTableCell &b) {
+                return a._column < b._column;
+            });
+            cells.erase(std::unique(cells.begin() + rowStart, cells.end(), [](const BsonTableCell &a, const BsonTableCell &b) {
+                return a._column == b._column;
+            }), cells.end());
+        }
+        rowStarts.push_back(cells.size());
+        cells.shrink_to_fit();
+
+        layout._columns.reserve(names.size());
+        for (size_t i = 0; i < names.size(); ++i)
+            layout._columns.push_back(QtUtils::toQString(names[i]));
+
+        emit progress(documents.size());
+        return true;
+    }
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <QThread>
+#include <memory>
+#include <vector>
+#include <mongo/bson/bsonobj.h>
+
+#include "robomongo/core/Core.h"
+
+namespace Robomongo
+{
+    /**
+     * @brief Column of table and index of its field in one document
+     */
+    struct BsonTableCell
+    {
+        int _column;
+        int _field;
+    };
+
+    /**
+     * @brief Columns of table and position of every cell's field in its document.
+     * Only present fields are stored, so memory grows with number of fields,
+     * not with rows * columns of sparse results.
+     */
+    struct BsonTableLayout
+    {
+        std::vector<QString> _columns;
+
+        /**
+         * @brief Cells of all rows one after another, every row sorted by column.
+         * Cells of row are in [_rowStarts[row], _rowStarts[row + 1]).
+         */
+        std::vector<BsonTableCell> _cells;
+        std::vector<size_t> _rowStarts;
+
+        /**
+         * @brief Index of field in document of row, -1 when document doesn't have such column
+         */
+        int field(int row, int column) const;
+
+        /**
+         * @brief Column of field in document of row, -1 when field isn't shown in table
+         */
+        int column(int row, int field) const;
+    };
+
+    /**
+     * @brief Documents of one result, prepared for tree and table models.
+     * Never modified after preparation, so it is shared between models and threads.
+     */
+    struct PreparedDocuments
+    {
+        PreparedDocuments() : _truncatedValues(false) {}
+
+        std::vector<mongo::BSONObj> _documents;
+        BsonTableLayout _layout;
+        bool _truncatedValues;  // documents were loaded with truncated top-level values
+    };
+
+    typedef std::shared_ptr<const PreparedDocuments> PreparedDocumentsPtr;
+
+    /*
+    ** In this thread we are preparing documents for BsonTreeModel and BsonTableModel
+    */
+    class ModelPrepareThread : public QThread
+    {
+        Q_OBJECT
+
+    public:
+        enum { progressStep = 1000 }; // documents
+
+        explicit ModelPrepareThread(const std::vector<MongoDocumentPtr> &documents, bool truncatedValues = false);
+        void stop();
+
+        /**
+         * @brief Prepared documents, available after thread is finished (NULL if stopped)
+         */
+        PreparedDocumentsPtr result() const { return _result; }
+
+    Q_SIGNALS:
+        /**
+         * @brief Signals number of processed documents
+         */
+        void progress(int processed);
+
+    protected:
+        virtual void run();
+
+    private:
+        bool buildLayout(PreparedDocuments &prepared);
+
+        const std::vector<MongoDocumentPtr> _bsonObjects;
+        const bool _truncatedValues;
+        PreparedDocumentsPtr _result;
+        volatile bool _stop;
+    };
+}
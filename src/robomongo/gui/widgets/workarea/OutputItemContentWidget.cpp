@@ -1,35 +1,83 @@
 #include "robomongo/gui/widgets/workarea/OutputItemContentWidget.h"
 
+#include <algorithm>
+
 #include <QVBoxLayout>
+#include <QLabel>
+#include <QLineEdit>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QProgressBar>
+#include <QProgressDialog>
+#include <QPushButton>
+#include <QTimer>
+#include <QKeyEvent>
+#include <QMessageBox>
 #include <Qsci/qscilexerjavascript.h>
+#include <mongo/client/dbclientinterface.h>
 
 #include "robomongo/core/AppRegistry.h"
 #include "robomongo/core/settings/SettingsManager.h"
 #include "robomongo/core/utils/QtUtils.h"
 #include "robomongo/core/domain/MongoShell.h"
+#include "robomongo/core/EventBus.h"
+#include "robomongo/core/domain/MongoServer.h"
+#include "robomongo/core/domain/MongoDocument.h"
+#include "robomongo/core/domain/ResultWriter.h"
+#include "robomongo/core/events/MongoEvents.h"
+#include "robomongo/core/utils/BsonUtils.h"
 
 #include "robomongo/gui/widgets/workarea/OutputWidget.h"
 #include "robomongo/gui/widgets/workarea/OutputItemHeaderWidget.h"
 #include "robomongo/gui/widgets/workarea/JsonPrepareThread.h"
+#include "robomongo/gui/widgets/workarea/JsonTextView.h"
+#include "robomongo/gui/widgets/workarea/ModelPrepareThread.h"
+#include "robomongo/gui/widgets/workarea/ResultSaveThread.h"
 #include "robomongo/gui/widgets/workarea/BsonTreeView.h"
 #include "robomongo/gui/widgets/workarea/BsonTreeModel.h"
+#include "robomongo/gui/widgets/workarea/BsonTreeItem.h"
 #include "robomongo/gui/widgets/workarea/BsonTableView.h"
 #include "robomongo/gui/widgets/workarea/BsonTableModel.h"
+#include "robomongo/gui/widgets/workarea/BsonSearchWidget.h"
 #include "robomongo/gui/editors/PlainJavaScriptEditor.h"
 #include "robomongo/gui/widgets/workarea/CollectionStatsTreeWidget.h"
+#include "robomongo/gui/widgets/workarea/ExplainTreeWidget.h"
 #include "robomongo/gui/GuiRegistry.h"
-#include "robomongo/gui/editors/JSLexer.h"
+#include "robomongo/gui/editors/JsonLexer.h"
 #include "robomongo/gui/editors/FindFrame.h"
 
+namespace
+{
+    size_t bsonSize(const std::vector<Robomongo::MongoDocumentPtr> &documents)
+    {
+        size_t size = 0;
+        for (size_t i = 0; i < documents.size(); ++i)
+            size += documents[i]->bsonObj().objsize();
+        return size;
+    }
+}
+
 namespace Robomongo
 {
     OutputItemContentWidget::OutputItemContentWidget(ViewMode viewMode, MongoShell *shell, const QString &text, double secs, 
                                                      bool multipleResults, bool firstItem, bool lastItem, QWidget *parent) :
         BaseClass(parent),
         _textView(NULL),
+        _virtualText(NULL),
         _bsonTreeview(NULL),
         _thread(NULL),
+        _prepareThread(NULL),
+        _loading(NULL),
+        _loadingProgress(NULL),
+        _saveProgress(NULL),
+        _saveTimer(NULL),
         _bsonTable(NULL),
+        _tablePage(NULL),
+        _tableFilter(NULL),
+        _tableFilterTimer(NULL),
+        _search(NULL),
+        _collectionStats(NULL),
+        _explain(NULL),
         _isTextModeSupported(true),
         _isTreeModeSupported(false),
         _isTableModeSupported(false),
@@ -39,6 +87,7 @@ namespace Robomongo
         _isCustomModeInitialized(false),
         _isTableModeInitialized(false),
         _isFirstPartRendered(false),
+        _isExplained(false),
         _text(text),
         _shell(shell),
         _outputWidget(dynamic_cast<OutputWidget*>(parentWidget())),
@@ -55,20 +104,34 @@ namespace Robomongo
                                                      double secs, bool multipleResults, bool firstItem, bool lastItem, QWidget *parent) :
         BaseClass(parent),
         _textView(NULL),
+        _virtualText(NULL),
         _bsonTreeview(NULL),
         _thread(NULL),
+        _prepareThread(NULL),
+        _loading(NULL),
+        _loadingProgress(NULL),
+        _saveProgress(NULL),
+        _saveTimer(NULL),
         _bsonTable(NULL),
+        _tablePage(NULL),
+        _tableFilter(NULL),
+        _tableFilterTimer(NULL),
+        _search(NULL),
+        _collectionStats(NULL),
+        _explain(NULL),
         _isTextModeSupported(true),
         _isTreeModeSupported(true),
         _isTableModeSupported(true),
-        _isCustomModeSupported(!type.isEmpty()),
+        _isCustomModeSupported(!type.isEmpty() || queryInfo._info.isValid()),
         _isTextModeInitialized(false),
         _isTreeModeInitialized(false),
         _isCustomModeInitialized(false),
         _isTableModeInitialized(false),
         _isFirstPartRendered(false),
+        _isExplained(false),
         _documents(documents),
         _queryInfo(queryInfo),
+        _userFields(queryInfo._fields),
         _type(type),
         _shell(shell),
         _initialSkip(queryInfo._skip),
@@ -80,6 +143,17 @@ namespace Robomongo
         setup(secs, multipleResults, firstItem, lastItem);
     }
 
+    OutputItemContentWidget::~OutputItemContentWidget()
+    {
+        // Thread deletes itself when finished
+        if (_prepareThread)
+            _prepareThread->stop();
+
+        // File is closed (and removed) by thread that writes it
+        if (_saveWriter)
+            _saveWriter->cancel();
+    }
+
     void OutputItemContentWidget::setup(double secs, bool multipleResults, bool firstItem, bool lastItem)
     {      
         setContentsMargins(0, 0, 0, 0);
@@ -92,6 +166,9 @@ namespace Robomongo
             if (!_queryInfo._limit) {
             _queryInfo._limit = 50;
             }
+
+            // Explain plan for "Explain" custom mode is loaded in background (see explainQuery)
+            AppRegistry::instance().bus()->subscribe(this, QueryExplainedEvent::Type, _shell);
         }
 
         _header->setTime(QString("%1 sec.").arg(secs));
@@ -102,8 +179,21 @@ namespace Robomongo
         layout->addWidget(_header);
         _stack = new QStackedWidget;
         layout->addWidget(_stack);
+        _search = new BsonSearchWidget;
+        _search->hide();
+        layout->addWidget(_search);
         setLayout(layout);
-        configureModel();
+
+        VERIFY(connect(_search, SIGNAL(matchSelected()), this, SLOT(showSearchMatch())));
+        VERIFY(connect(_search, SIGNAL(closed()), this, SLOT(searchClosed())));
+
+        // Table is filtered when user stops typing
+        _tableFilterTimer = new QTimer(this);
+        _tableFilterTimer->setSingleShot(true);
+        _tableFilterTimer->setInterval(tableFilterDelayMs);
+        VERIFY(connect(_tableFilterTimer, SIGNAL(timeout()), this, SLOT(filterTable())));
+
+        prepareModels();
 
         VERIFY(connect(_header->paging(), SIGNAL(refreshed(int, int)), this, SLOT(refresh(int, int))));
         VERIFY(connect(_header->paging(), SIGNAL(leftClicked(int, int)), this, SLOT(paging_leftClicked(int, int))));
@@ -167,12 +257,287 @@ namespace Robomongo
         info._limit = limit;
         info._skip = skip;
         info._batchSize = batchSize;
+        info._fields = _userFields;
+        info._projectedColumns = false;
+        info._truncateValues = AppRegistry::instance().settingsManager()->truncateLongValues();
+        if (_viewMode == Table)
+            projectColumns(info);
+
         _outputWidget->showProgress();
         _shell->query(_outputWidget->resultIndex(this), info);
     }
 
+    void OutputItemContentWidget::projectColumns(MongoQueryInfo &info) const
+    {
+        if (!_userFields.isEmpty() || _hiddenColumns.isEmpty())
+            return;
+
+        // Only hidden columns are excluded, so fields that first appear on other pages are still loaded.
+        // _id is never excluded, it is needed to edit, delete and load full documents.
+        mongo::BSONObjBuilder builder;
+        for (int i = 0; i < _hiddenColumns.count(); ++i) {
+            const QString &name = _hiddenColumns[i];
+            if (name == "_id")
+                continue;
+
+            // Such names can't be used in projection, full documents are loaded
+            if (name.contains('.') || name.startsWith('$') || name.startsWith('['))
+                return;
+
+            builder.append(QtUtils::toStdString(name), 0);
+        }
+
+        if (builder.asTempObj().isEmpty())
+            return;
+
+        info._fields = builder.obj();
+        info._projectedColumns = true;
+    }
+
+    void OutputItemContentWidget::loadFullDocuments()
+    {
+        if (_queryInfo._projectedColumns)
+            refresh(_queryInfo._skip, _queryInfo._batchSize);
+    }
+
+    void OutputItemContentWidget::treeItemExpanded(const QModelIndex &index)
+    {
+        // Recursive expansion doesn't load values, it would rebuild tree many times
+        if (_bsonTreeview->isExpandingRecursively())
+            return;
+
+        BsonTreeItem *item = QtUtils::item<BsonTreeItem*>(index);
+        if (!item || !item->isTruncated())
+            return;
+
+        loadTruncatedValue(item->superParent()->row(), item->row());
+    }
+
+    void OutputItemContentWidget::loadTruncatedValue(int document, int field)
+    {
+        // One value is loaded at a time
+        if (!_loadingValue.empty() || document >= static_cast<int>(_documents.size()))
+            return;
+
+        mongo::BSONObj obj = _documents[document]->bsonObj();
+        mongo::BSONElement id = obj.getField("_id");
+        mongo::BSONElement element = BsonUtils::indexOf(obj, field);
+        if (id.eoo() || element.eoo())
+            return;
+
+        mongo::BSONObjBuilder builder;
+        builder.append(id);
+
+        MongoQueryInfo info(_queryInfo);
+        info._query = builder.obj();
+        info._fields = BSON(element.fieldName() << 1);
+        info._special = false;
+        info._skip = 0;
+        info._limit = 1;
+        info._batchSize = 1;
+        info._projectedColumns = false;
+        info._truncateValues = false;
+
+        _loadingValue.push_back(document);
+        _loadingValue.push_back(field);
+        AppRegistry::instance().bus()->send(_shell->server()->worker(),
+            new ExecuteQueryRequest(this, document, info));
+    }
+
+    void OutputItemContentWidget::handle(ExecuteQueryResponse *event)
+    {
+        std::vector<int> path;
+        path.swap(_loadingValue);
+        if (path.empty())
+            return;
+
+        if (event->isError()) {
+            QMessageBox::warning(this, "Database Error", QtUtils::toQString(event->error().errorMessage()));
+            return;
+        }
+
+        // Other page could be loaded meanwhile
+        if (event->documents.empty() || path[0] >= static_cast<int>(_documents.size()))
+            return;
+
+        mongo::BSONObj full = event->documents.front()->bsonObj();
+        mongo::BSONObj obj = _documents[path[0]]->bsonObj();
+        if (obj.getField("_id").woCompare(full.getField("_id"), false) != 0)
+            return;
+
+        // Truncated field is replaced with full value, other fields are kept
+        mongo::BSONObjBuilder builder;
+        mongo::BSONObjIterator iterator(obj);
+        for (int i = 0; iterator.more(); ++i) {
+            mongo::BSONElement element = iterator.next();
+            mongo::BSONElement value = i == path[1] ? full.getField(element.fieldName()) : mongo::BSONElement();
+            builder.append(value.eoo() ? element : value);
+        }
+
+        std::vector<MongoDocumentPtr> documents(_documents);
+        documents[path[0]] = MongoDocumentPtr(new MongoDocument(builder.obj()));
+
+        _shownValue = path;
+        update(_queryInfo, documents);
+        refreshOutputItem();
+    }
+
+    void OutputItemContentWidget::saveResult()
+    {
+        // One file is saved at a time
+        if (_saveWriter)
+            return;
+
+        bool wholeQuery = false;
+        if (_queryInfo._info.isValid()) {
+            QMessageBox box(QMessageBox::Question, "Save Result to File",
+                            "Save documents of current page or all documents of query?", QMessageBox::Cancel, this);
+            QPushButton *page = box.addButton("Current Page", QMessageBox::AcceptRole);
+            QPushButton *query = box.addButton("Whole Query", QMessageBox::AcceptRole);
+            box.setDefaultButton(page);
+            box.exec();
+            if (box.clickedButton() != page && box.clickedButton() != query)
+                return;
+            wholeQuery = box.clickedButton() == query;
+        }
+        else if (_documents.empty()) {
+            return;
+        }
+
+        // In order of ResultWriter::Format
+        QStringList filters;
+        filters << "JSON (*.json)" << "NDJSON (*.ndjson)" << "Relaxed Extended JSON (*.json)";
+        QString filter = filters.front();
+        const QString name = _queryInfo._info.isValid() ? QtUtils::toQString(_queryInfo._info._ns.collectionName()) : "result";
+        const QString path = QFileDialog::getSaveFileName(this, "Save Result to File", name + ".json", filters.join(";;"), &filter);
+        if (path.isEmpty())
+            return;
+
+        const ResultWriter::Format format = static_cast<ResultWriter::Format>(std::max(0, filters.indexOf(filter)));
+        SettingsManager *settings = AppRegistry::instance().settingsManager();
+        std::shared_ptr<ResultWriter> writer(new ResultWriter(path, format, settings->uuidEncoding(), settings->timeZone()));
+        if (!writer->open()) {
+            QMessageBox::critical(this, "Save Result to File", "Cannot create file:\n" + writer->error());
+            return;
+        }
+        _saveWriter = writer;
+
+        // Query runs again for whole result, and for page which was loaded without
+        // hidden columns or with truncated values. Documents are written as they come.
+        if (wholeQuery || _queryInfo._projectedColumns || _queryInfo._truncateValues) {
+            MongoQueryInfo info(_queryInfo);
+            if (wholeQuery) {
+                info._skip = _initialSkip;
+                info._limit = _initialLimit;
+                info._batchSize = 0;        // batches of server's size
+            }
+            else {
+                info._limit = _documents.empty() ? -1 : static_cast<int>(_documents.size());
+            }
+            info._fields = _userFields;
+            info._projectedColumns = false;
+            info._truncateValues = false;
+            AppRegistry::instance().bus()->send(_shell->server()->worker(), new SaveQueryRequest(this, info, writer));
+        }
+        else {
+            ResultSaveThread *thread = new ResultSaveThread(_documents, writer);
+            VERIFY(connect(thread, SIGNAL(finished()), this, SLOT(resultSaved())));
+            VERIFY(connect(thread, SIGNAL(finished()), thread, SLOT(deleteLater())));
+            thread->start();
+        }
+
+        if (!_saveProgress) {
+            _saveProgress = new QProgressDialog(this);
+            _saveProgress->setWindowTitle("Save Result to File");
+            _saveProgress->setAutoClose(false);
+            _saveProgress->setAutoReset(false);
+            VERIFY(connect(_saveProgress, SIGNAL(canceled()), this, SLOT(cancelSave())));
+
+            _saveTimer = new QTimer(this);
+            _saveTimer->setInterval(saveProgressMs);
+            VERIFY(connect(_saveTimer, SIGNAL(timeout()), this, SLOT(updateSaveProgress())));
+        }
+
+        // Size of whole result is unknown, busy indicator is shown
+        _saveProgress->setRange(0, wholeQuery ? 0 : static_cast<int>(_documents.size()));
+        _saveProgress->setValue(0);
+        updateSaveProgress();
+        _saveProgress->show();
+        _saveTimer->start();
+    }
+
+    void OutputItemContentWidget::updateSaveProgress()
+    {
+        if (!_saveWriter)
+            return;
+
+        const long long written = _saveWriter->written();
+        if (_saveProgress->maximum() > 0)
+            _saveProgress->setValue(static_cast<int>(std::min<long long>(written, _saveProgress->maximum())));
+
+        _saveProgress->setLabelText(QString("Saving to %1...\n%2 documents written")
+                                    .arg(QFileInfo(_saveWriter->path()).fileName()).arg(written));
+    }
+
+    void OutputItemContentWidget::cancelSave()
+    {
+        // Dialog is hidden when writing thread closes file
+        if (_saveWriter) {
+            _saveWriter->cancel();
+            _saveProgress->setLabelText("Cancelling...");
+        }
+    }
+
+    void OutputItemContentWidget::resultSaved()
+    {
+        ResultSaveThread *thread = qobject_cast<ResultSaveThread *>(sender());
+        if (thread && thread->writer() == _saveWriter)
+            finishSave(QString());
+    }
+
+    void OutputItemContentWidget::handle(SaveQueryResponse *event)
+    {
+        if (event->writer() != _saveWriter)
+            return;
+
+        finishSave(event->isError() ? QtUtils::toQString(event->error().errorMessage()) : QString());
+    }
+
+    void OutputItemContentWidget::finishSave(const QString &error)
+    {
+        std::shared_ptr<ResultWriter> writer;
+        writer.swap(_saveWriter);
+        _saveTimer->stop();
+        _saveProgress->hide();
+
+        const QString message = error.isEmpty() ? writer->error() : error;
+        if (!message.isEmpty())
+            QMessageBox::critical(this, "Save Result to File", "Cannot save result to file:\n" + message);
+    }
+
+    void OutputItemContentWidget::tableColumnsChanged()
+    {
+        if (!_bsonTable)
+            return;
+
+        QStringList previous = _hiddenColumns;
+        _hiddenColumns = _bsonTable->hiddenColumns();
+
+        // Columns that are shown again but were not loaded
+        bool isReloadNeeded = false;
+        for (int i = 0; i < previous.count(); ++i) {
+            if (!_hiddenColumns.contains(previous[i]) && !_bsonTable->hasColumn(previous[i]))
+                isReloadNeeded = true;
+        }
+
+        if (isReloadNeeded)
+            refresh(_queryInfo._skip, _queryInfo._batchSize);
+    }
+
     void OutputItemContentWidget::update(const MongoQueryInfo &inf, const std::vector<MongoDocumentPtr> &documents)
     {
+        // Other page is shown, its plan is loaded again. Full value of field keeps the page.
+        const bool otherPage = inf._skip != _queryInfo._skip || inf._limit != _queryInfo._limit;
         _queryInfo = inf;
         _documents = documents;
 
@@ -183,10 +548,12 @@ namespace Robomongo
         _isFirstPartRendered = false;
         markUninitialized();
 
-        if (_bsonTable) {
-            _stack->removeWidget(_bsonTable);
-            delete _bsonTable;
+        if (_tablePage) {
+            _stack->removeWidget(_tablePage);
+            delete _tablePage;
+            _tablePage = NULL;
             _bsonTable = NULL;
+            _tableFilter = NULL;
         }
 
         if (_bsonTreeview) {
@@ -200,42 +567,70 @@ namespace Robomongo
             delete _textView;
             _textView = NULL;
         }
-        configureModel();
+
+        if (_virtualText) {
+            _stack->removeWidget(_virtualText);
+            delete _virtualText;
+            _virtualText = NULL;
+        }
+
+        if (_explain) {
+            _stack->removeWidget(_explain);
+            delete _explain;
+            _explain = NULL;
+        }
+        prepareModels();
+
+        if (otherPage)
+            explainQuery();
     }
 
     void OutputItemContentWidget::showText()
     {
         _viewMode = Text;
         _header->showText();
+        _search->hide();
+        loadFullDocuments();
         if (!_isTextModeSupported)
             return;
 
         if (!_isTextModeInitialized)
         {
-            _textView = configureLogText();
-            if (!_text.isEmpty()) {
-                _textView->sciScintilla()->setText(_text);
+            if (_text.isEmpty() && bsonSize(_documents) > virtualTextSize) {
+                // Only visible lines of large results are formatted, whole text is never built
+                _virtualText = new JsonTextView(_documents, AppRegistry::instance().settingsManager()->uuidEncoding(), AppRegistry::instance().settingsManager()->timeZone(), this);
+                _stack->addWidget(_virtualText);
             }
             else {
-                if (_documents.size() > 0) {
-                    _textView->sciScintilla()->setText("Loading...");
-                    _thread = new JsonPrepareThread(_documents, AppRegistry::instance().settingsManager()->uuidEncoding(), AppRegistry::instance().settingsManager()->timeZone());
-                    VERIFY(connect(_thread, SIGNAL(partReady(const QString&)), this, SLOT(jsonPartReady(const QString&))));
-                    VERIFY(connect(_thread, SIGNAL(finished()), _thread, SLOT(deleteLater())));
-                    _thread->start();
+                _textView = configureLogText();
+                if (!_text.isEmpty()) {
+                    _textView->sciScintilla()->setText(_text);
+                }
+                else {
+                    if (_documents.size() > 0) {
+                        _textView->sciScintilla()->setText("Loading...");
+                        _thread = new JsonPrepareThread(_documents, AppRegistry::instance().settingsManager()->uuidEncoding(), AppRegistry::instance().settingsManager()->timeZone());
+                        VERIFY(connect(_thread, SIGNAL(partReady(const QString&)), this, SLOT(jsonPartReady(const QString&))));
+                        VERIFY(connect(_thread, SIGNAL(finished()), _thread, SLOT(deleteLater())));
+                        _thread->start();
+                    }
                 }
+                _stack->addWidget(_textView);
             }
-            _stack->addWidget(_textView);
             _isTextModeInitialized = true;
         }
 
-        _stack->setCurrentWidget(_textView);
+        if (_virtualText)
+            _stack->setCurrentWidget(_virtualText);
+        else
+            _stack->setCurrentWidget(_textView);
     }
 
     void OutputItemContentWidget::showTree()
     {
         _viewMode = Tree;
         _header->showTree();
+        loadFullDocuments();
         if (!_isTreeModeSupported) {
             // try to downgrade to text mode
             showText();
@@ -244,9 +639,16 @@ namespace Robomongo
         }
 
         if (!_isTreeModeInitialized) {
+            if (!_mod) {
+                showLoading();
+                return;
+            }
+
             _bsonTreeview = new BsonTreeView(_shell, _queryInfo);
             _bsonTreeview->setModel(_mod);
             _stack->addWidget(_bsonTreeview);
+            VERIFY(connect(_bsonTreeview, SIGNAL(expanded(const QModelIndex&)), this, SLOT(treeItemExpanded(const QModelIndex&))));
+            VERIFY(connect(_bsonTreeview, SIGNAL(saveResultRequested()), this, SLOT(saveResult())));
 
             if (true == AppRegistry::instance().settingsManager()->autoExpand())
                 // Expanding only one level, because on large
@@ -263,6 +665,7 @@ namespace Robomongo
     {
         _viewMode = Custom;
         _header->showCustom();
+        _search->hide();
 
         if (!_isCustomModeSupported) {
             // try to downgrade to tree mode
@@ -276,12 +679,57 @@ namespace Robomongo
             if (_type == "collectionStats") {
                 _collectionStats = new CollectionStatsTreeWidget(_documents, NULL);
                 _stack->addWidget(_collectionStats);
-            }               
+            }
+            else if (_queryInfo._info.isValid()) {
+                _explain = new ExplainTreeWidget(NULL);
+                _stack->addWidget(_explain);
+                showExplain();
+            }
             _isCustomModeInitialized = true;
         }
 
         if (_collectionStats)
             _stack->setCurrentWidget(_collectionStats);
+        else if (_explain)
+            _stack->setCurrentWidget(_explain);
+    }
+
+    void OutputItemContentWidget::explainQuery()
+    {
+        if (!_queryInfo._info.isValid() || _type == "collectionStats")
+            return;
+
+        _isExplained = false;
+        _explainResult = mongo::BSONObj();
+        _explainError.clear();
+        if (_explain)
+            _explain->showLoading();
+
+        _shell->explain(_outputWidget->resultIndex(this), _queryInfo);
+    }
+
+    void OutputItemContentWidget::handle(QueryExplainedEvent *event)
+    {
+        // Other results of the same shell receive this event too
+        if (event->resultIndex() != _outputWidget->resultIndex(this))
+            return;
+
+        _isExplained = true;
+        _explainResult = event->isError() ? mongo::BSONObj() : event->explain().getOwned();
+        _explainError = event->isError() ? QtUtils::toQString(event->error().errorMessage()) : QString();
+        showExplain();
+    }
+
+    void OutputItemContentWidget::showExplain()
+    {
+        // Until plan arrives, widget shows "Loading..."
+        if (!_explain || !_isExplained)
+            return;
+
+        if (!_explainError.isEmpty())
+            _explain->showError(_explainError);
+        else
+            _explain->setExplain(_explainResult);
     }
 
     void OutputItemContentWidget::showTable()
@@ -296,15 +744,77 @@ namespace Robomongo
         }
 
         if (!_isTableModeInitialized) {
+            if (!_prepared) {
+                showLoading();
+                return;
+            }
+
             _bsonTable = new BsonTableView(_shell, _queryInfo);
-            BsonTableModelProxy *modp = new BsonTableModelProxy(_bsonTable);
-            modp->setSourceModel(_mod);
-            _bsonTable->setModel(modp);
-            _stack->addWidget(_bsonTable);
+            BsonTableModel *model = new BsonTableModel(_prepared, _bsonTable);
+            _bsonTable->setModel(model);
+            _bsonTable->setHiddenColumns(_hiddenColumns);
+            VERIFY(connect(_bsonTable, SIGNAL(hiddenColumnsChanged()), this, SLOT(tableColumnsChanged())));
+
+            _tableFilter = new QLineEdit;
+            _tableFilter->setPlaceholderText("Filter rows by value");
+            _tableFilter->setClearButtonEnabled(true);
+            VERIFY(connect(_tableFilter, SIGNAL(textChanged(const QString&)), _tableFilterTimer, SLOT(start())));
+
+            _tablePage = new QWidget;
+            QVBoxLayout *layout = new QVBoxLayout;
+            layout->setContentsMargins(0, 0, 0, 0);
+            layout->setSpacing(0);
+            layout->addWidget(_tableFilter);
+            layout->addWidget(_bsonTable);
+            _tablePage->setLayout(layout);
+
+            _stack->addWidget(_tablePage);
             _isTableModeInitialized = true;
         }
 
-        _stack->setCurrentWidget(_bsonTable);
+        _stack->setCurrentWidget(_tablePage);
+    }
+
+    void OutputItemContentWidget::filterTable()
+    {
+        if (!_bsonTable || !_tableFilter)
+            return;
+
+        BsonTableModel *model = qobject_cast<BsonTableModel *>(_bsonTable->model());
+        if (model)
+            model->setFilter(_tableFilter->text());
+    }
+
+    void OutputItemContentWidget::keyPressEvent(QKeyEvent *event)
+    {
+        // Text view has its own search (FindFrame), key gets here only from tree and table
+        bool isSearchable = (_viewMode == Tree || _viewMode == Table) && _prepared;
+        if ((event->modifiers() & Qt::ControlModifier) && event->key() == Qt::Key_F && isSearchable) {
+            _search->showSearch();
+            return event->accept();
+        }
+
+        return BaseClass::keyPressEvent(event);
+    }
+
+    void OutputItemContentWidget::showSearchMatch()
+    {
+        const BsonPath path = _search->currentMatch();
+        if (path.empty())
+            return;
+
+        if (_viewMode == Tree && _bsonTreeview)
+            _bsonTreeview->showPath(path);
+        else if (_viewMode == Table && _bsonTable)
+            _bsonTable->showPath(path);
+    }
+
+    void OutputItemContentWidget::searchClosed()
+    {
+        if (_viewMode == Tree && _bsonTreeview)
+            _bsonTreeview->setFocus();
+        else if (_viewMode == Table && _bsonTable)
+            _bsonTable->setFocus();
     }
 
     void OutputItemContentWidget::markUninitialized()
@@ -348,22 +858,98 @@ namespace Robomongo
         }
     }
     
-    BsonTreeModel *OutputItemContentWidget::configureModel()
+    void OutputItemContentWidget::prepareModels()
     {
         delete _mod;
-        _mod = new BsonTreeModel(_documents, this);
-        return _mod;
+        _mod = NULL;
+        _prepared.reset();
+        _search->setDocuments(_prepared);
+
+        // Previous thread deletes itself when finished, its result is ignored
+        if (_prepareThread) {
+            _prepareThread->stop();
+            _prepareThread = NULL;
+        }
+
+        if (!_isTreeModeSupported)
+            return;
+
+        if (_loadingProgress) {
+            _loadingProgress->setRange(0, _documents.size());
+            _loadingProgress->setValue(0);
+        }
+
+        _prepareThread = new ModelPrepareThread(_documents, _queryInfo._truncateValues);
+        VERIFY(connect(_prepareThread, SIGNAL(progress(int)), this, SLOT(modelPrepareProgress(int))));
+        VERIFY(connect(_prepareThread, SIGNAL(finished()), this, SLOT(modelPrepared())));
+        VERIFY(connect(_prepareThread, SIGNAL(finished()), _prepareThread, SLOT(deleteLater())));
+        _prepareThread->start();
+    }
+
+    void OutputItemContentWidget::modelPrepareProgress(int processed)
+    {
+        if (_loadingProgress && sender() == _prepareThread)
+            _loadingProgress->setValue(processed);
+    }
+
+    void OutputItemContentWidget::modelPrepared()
+    {
+        ModelPrepareThread *thread = qobject_cast<ModelPrepareThread *>(sender());
+        if (!thread || thread != _prepareThread)
+            return;
+
+        _prepareThread = NULL;
+        _prepared = thread->result();
+        if (!_prepared)
+            return;
+
+        _mod = new BsonTreeModel(_prepared, this);
+        _search->setDocuments(_prepared);
+
+        // Replace "Loading" placeholder with the view of current mode
+        if (_loading && _stack->currentWidget() == _loading)
+            refreshOutputItem();
+
+        // Field which full value was loaded is expanded again
+        if (!_shownValue.empty() && _viewMode == Tree && _bsonTreeview) {
+            _bsonTreeview->showPath(_shownValue);
+            _bsonTreeview->expand(_bsonTreeview->currentIndex());
+        }
+        _shownValue.clear();
+    }
+
+    void OutputItemContentWidget::showLoading()
+    {
+        if (!_loading) {
+            _loading = new QWidget;
+            QLabel *label = new QLabel("Preparing results...");
+            label->setAlignment(Qt::AlignHCenter);
+            _loadingProgress = new QProgressBar;
+            _loadingProgress->setRange(0, _documents.size());
+            _loadingProgress->setFixedWidth(300);
+
+            QVBoxLayout *layout = new QVBoxLayout;
+            layout->addStretch(1);
+            layout->addWidget(label, 0, Qt::AlignHCenter);
+            layout->addWidget(_loadingProgress, 0, Qt::AlignHCenter);
+            layout->addStretch(1);
+            _loading->setLayout(layout);
+            _stack->addWidget(_loading);
+        }
+
+        _stack->setCurrentWidget(_loading);
     }
 
     FindFrame *Robomongo::OutputItemContentWidget::configureLogText()
     {
         const QFont &textFont = GuiRegistry::instance().font();
 
-        QsciLexerJavaScript *javaScriptLexer = new JSLexer(this);
-        javaScriptLexer->setFont(textFont);
+        // Output is styled by JSON lexer, only lines that are shown
+        JsonLexer *jsonLexer = new JsonLexer(this);
+        jsonLexer->setFont(textFont);
 
         FindFrame *_logText = new FindFrame(this);
-        _logText->sciScintilla()->setLexer(javaScriptLexer);
+        _logText->sciScintilla()->setLexer(jsonLexer);
         _logText->sciScintilla()->setTabWidth(4);        
         _logText->sciScintilla()->setAppropriateBraceMatching();
         _logText->sciScintilla()->setFont(textFont);
@@ -1,20 +1,38 @@
 #pragma once
 
 #include <QStackedWidget>
+#include <QStringList>
+#include <memory>
 
 #include "robomongo/core/Core.h"
 #include "robomongo/core/domain/MongoQueryInfo.h"
 #include "robomongo/core/Enums.h"
 #include <vector>
 
+QT_BEGIN_NAMESPACE
+class QLineEdit;
+class QProgressBar;
+class QProgressDialog;
+class QTimer;
+QT_END_NAMESPACE
+
 namespace Robomongo
 {
     class FindFrame;
     class BsonTreeView;
     class BsonTableView;
     class BsonTreeModel;
+    class BsonSearchWidget;
     class JsonPrepareThread;
+    class JsonTextView;
+    class ModelPrepareThread;
+    struct PreparedDocuments;
     class CollectionStatsTreeWidget;
+    class ExplainTreeWidget;
+    class QueryExplainedEvent;
+    class ExecuteQueryResponse;
+    class SaveQueryResponse;
+    class ResultWriter;
     class MongoShell;
     class OutputItemHeaderWidget;
     class OutputWidget;
@@ -25,11 +43,16 @@ namespace Robomongo
 
     public:
         typedef QWidget BaseClass;
+        enum { tableFilterDelayMs = 300 };
+        enum { virtualTextSize = 4 * 1024 * 1024 };  // BSON bytes of documents shown by JsonTextView in text mode
+        enum { saveProgressMs = 100 };
+
         OutputItemContentWidget(ViewMode viewMode, MongoShell *shell, const QString &text, double secs,
                                 bool multipleResults, bool firstItem, bool lastItem, QWidget *parent);
         OutputItemContentWidget(ViewMode viewMode, MongoShell *shell, const QString &type,
                                 const std::vector<MongoDocumentPtr> &documents, const MongoQueryInfo &queryInfo, 
                                 double secs, bool multipleResults, bool firstItem, bool lastItem, QWidget *parent);
+        ~OutputItemContentWidget();
         int _initialSkip;
         int _initialLimit;
         void update(const MongoQueryInfo &inf, const std::vector<MongoDocumentPtr> &documents);
@@ -42,6 +65,12 @@ namespace Robomongo
         void refreshOutputItem();
         void markUninitialized();
 
+        /**
+         * @brief Starts loading of explain plan of query in background, as soon as result
+         * is shown. Plan is kept and is shown in "Explain" custom mode.
+         */
+        void explainQuery();
+
         void applyDockUndockSettings(bool isDocking) const;
         void toggleOrientation(Qt::Orientation orientation) const;
 
@@ -55,30 +84,106 @@ namespace Robomongo
         void showTable();
         void showCustom();
 
+        void handle(QueryExplainedEvent *event);
+
+        /**
+         * @brief Full value of truncated field is loaded
+         */
+        void handle(ExecuteQueryResponse *event);
+
+        /**
+         * @brief Saves documents of current page, or of whole query, to file chosen
+         * by user. Documents are written in background, in chosen format.
+         */
+        void saveResult();
+
+        /**
+         * @brief Query saved to file by MongoWorker
+         */
+        void handle(SaveQueryResponse *event);
+
     private Q_SLOTS:
         void jsonPartReady(const QString &json);
+        void modelPrepared();
+        void modelPrepareProgress(int processed);
+        void filterTable();
+        void showSearchMatch();
+        void tableColumnsChanged();
+        void treeItemExpanded(const QModelIndex &index);
+        void searchClosed();
         void refresh(int skip, int batchSize);
         void paging_rightClicked(int skip, int batchSize);
         void paging_leftClicked(int skip, int limit);      
+        void resultSaved();
+        void updateSaveProgress();
+        void cancelSave();
+
+    protected:
+        virtual void keyPressEvent(QKeyEvent *event);
 
     private:
         void setup(double secs, bool multipleResults, bool firstItem, bool lastItem);
         FindFrame *configureLogText();
-        BsonTreeModel *configureModel();
+
+        /**
+         * @brief Starts preparation of documents for tree and table models in
+         * ModelPrepareThread. Views are created when models are ready.
+         */
+        void prepareModels();
+
+        /**
+         * @brief Excludes hidden columns of table (except _id) from projection of 'info',
+         * when user hid some columns and query has no projection of its own.
+         */
+        void projectColumns(MongoQueryInfo &info) const;
+
+        /**
+         * @brief Reloads current page with full documents, when it was loaded
+         * with projection of table columns and other view is shown now.
+         */
+        void loadFullDocuments();
+
+        /**
+         * @brief Loads full value of truncated top-level 'field' of 'document' by _id.
+         * Document is replaced and views are rebuilt when value arrives.
+         */
+        void loadTruncatedValue(int document, int field);
+        void showLoading();
+        void showExplain();
+        void finishSave(const QString &error);
 
         FindFrame *_textView;
+        JsonTextView *_virtualText;     // text of large results
         BsonTreeView *_bsonTreeview;
         BsonTableView *_bsonTable;
+        QWidget *_tablePage;            // filter and table
+        QLineEdit *_tableFilter;
+        QTimer *_tableFilterTimer;
+        BsonSearchWidget *_search;      // search in tree and table
         BsonTreeModel *_mod;
         CollectionStatsTreeWidget *_collectionStats;
+        ExplainTreeWidget *_explain;
+        mongo::BSONObj _explainResult;  // explain plan of query, when loaded without error
+        QString _explainError;
 
         QString _text;
         QString _type; // type of request
         std::vector<MongoDocumentPtr> _documents;
         MongoQueryInfo _queryInfo;
+        mongo::BSONObj _userFields;     // projection of query itself
+        QStringList _hiddenColumns;     // hidden columns of table
+        std::vector<int> _loadingValue;   // document and field which full value is loading
+        std::vector<int> _shownValue;     // document and field to show when tree is rebuilt
 
         QStackedWidget *_stack;
         JsonPrepareThread *_thread;
+        ModelPrepareThread *_prepareThread;
+        std::shared_ptr<const PreparedDocuments> _prepared;
+        QWidget *_loading;
+        QProgressBar *_loadingProgress;
+        std::shared_ptr<ResultWriter> _saveWriter;  // file that is being saved
+        QProgressDialog *_saveProgress;
+        QTimer *_saveTimer;
 
         MongoShell *_shell;
         OutputItemHeaderWidget *_header;
@@ -94,6 +199,7 @@ namespace Robomongo
         bool _isCustomModeInitialized;
 
         bool _isFirstPartRendered;
+        bool _isExplained;              // explain plan (or its error) is received
         ViewMode _viewMode;
     };
 }
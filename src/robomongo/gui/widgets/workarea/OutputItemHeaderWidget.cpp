@@ -77,6 +77,14 @@ namespace Robomongo
         _customButton->setFlat(true);
         _customButton->setCheckable(true);
 
+        // Save to file button
+        _saveButton = new QPushButton(this);
+        _saveButton->hide();
+        _saveButton->setIcon(GuiRegistry::instance().saveIcon());
+        _saveButton->setToolTip("Save result to file");
+        _saveButton->setFixedSize(24, 24);
+        _saveButton->setFlat(true);
+
         // Create maximize button only if there are multiple results
         if (_multipleResults) {
             _maxButton = new QPushButton;
@@ -101,6 +109,7 @@ namespace Robomongo
         VERIFY(connect(_treeButton, SIGNAL(clicked()), outputItemContentWidget, SLOT(showTree())));
         VERIFY(connect(_tableButton, SIGNAL(clicked()), outputItemContentWidget, SLOT(showTable())));
         VERIFY(connect(_customButton, SIGNAL(clicked()), outputItemContentWidget, SLOT(showCustom())));
+        VERIFY(connect(_saveButton, SIGNAL(clicked()), outputItemContentWidget, SLOT(saveResult())));
 
         _collectionIndicator = new Indicator(GuiRegistry::instance().collectionIcon());
         _timeIndicator = new Indicator(GuiRegistry::instance().timeIcon());
@@ -119,6 +128,13 @@ namespace Robomongo
         QSpacerItem *hSpacer = new QSpacerItem(2000, 24, QSizePolicy::Preferred, QSizePolicy::Minimum);
         layout->addSpacerItem(hSpacer);
         layout->addWidget(_paging);
+
+        // Only documents can be saved
+        if (outputItemContentWidget->isTreeModeSupported()) {
+            layout->addWidget(_saveButton, 0, Qt::AlignRight);
+            _saveButton->show();
+        }
+
         layout->addWidget(createVerticalLine());
         layout->addSpacing(2);
 
@@ -65,6 +65,9 @@ namespace Robomongo
             VERIFY(connect(item, SIGNAL(restoredSize()), this, SLOT(restoreSize())));
             _splitter->addWidget(item);
             _outputItemContentWidgets.push_back(item);
+
+            // Plan is loaded together with result, index of result is known now
+            item->explainQuery();
         }
         
         tryToMakeAllPartsEqualInSize();
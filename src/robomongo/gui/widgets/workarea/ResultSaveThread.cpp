@@ -0,0 +1,23 @@
+#include "robomongo/gui/widgets/workarea/ResultSaveThread.h"
+
+#include "robomongo/core/domain/MongoDocument.h"
+
+namespace Robomongo
+{
+    ResultSaveThread::ResultSaveThread(const std::vector<MongoDocumentPtr> &documents, const ResultWriterPtr &writer) :
+        _documents(documents),
+        _writer(writer)
+    {
+    }
+
+    void ResultSaveThread::run()
+    {
+        // Writing stops when it is cancelled or failed
+        for (size_t i = 0; i < _documents.size(); ++i) {
+            if (!_writer->write(_documents[i]->bsonObj()))
+                break;
+        }
+
+        _writer->close();
+    }
+}
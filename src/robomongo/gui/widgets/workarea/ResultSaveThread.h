@@ -0,0 +1,30 @@
+#pragma once
+
+#include <QThread>
+#include <vector>
+
+#include "robomongo/core/Core.h"
+#include "robomongo/core/domain/ResultWriter.h"
+
+namespace Robomongo
+{
+    /*
+    ** In this thread we are writing already loaded documents to file
+    */
+    class ResultSaveThread : public QThread
+    {
+        Q_OBJECT
+
+    public:
+        ResultSaveThread(const std::vector<MongoDocumentPtr> &documents, const ResultWriterPtr &writer);
+
+        ResultWriterPtr writer() const { return _writer; }
+
+    protected:
+        virtual void run();
+
+    private:
+        const std::vector<MongoDocumentPtr> _documents;
+        const ResultWriterPtr _writer;
+    };
+}
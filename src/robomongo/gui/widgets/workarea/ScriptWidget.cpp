@@ -4,6 +4,7 @@
 #include <QKeyEvent>
 #include <QCompleter>
 #include <QStringListModel>
+#include <QTimer>
 #include <Qsci/qscilexerjavascript.h>
 #include <Qsci/qsciscintilla.h>
 
@@ -75,6 +76,11 @@ namespace Robomongo
 
         _queryText->sciScintilla()->installEventFilter(this);
 
+        _autocompletionTimer = new QTimer(this);
+        _autocompletionTimer->setSingleShot(true);
+        _autocompletionTimer->setInterval(autocompletionDelayMs);
+        VERIFY(connect(_autocompletionTimer, SIGNAL(timeout()), this, SLOT(showAutocompletion())));
+
         _completer = new QCompleter(this);
         _completer->setWidget(_queryText->sciScintilla());
         _completer->setCompletionMode(QCompleter::PopupCompletion);
@@ -212,6 +218,10 @@ namespace Robomongo
 
     void ScriptWidget::hideAutocompletion()
     {
+        // Completions requested for previous text are not relevant anymore
+        _autocompletionTimer->stop();
+        _shell->cancelAutocomplete();
+
         _completer->popup()->hide();
         RoboScintilla *scin = static_cast<RoboScintilla*>(_queryText->sciScintilla());
         scin->setIgnoreEnterKey(false);
@@ -260,7 +270,8 @@ namespace Robomongo
     void ScriptWidget::onCursorPositionChanged(int line, int index)
     {
         if (!_disableTextAndCursorNotifications && _textChanged) {
-            showAutocompletion();
+            // Restart the timer on every keystroke, so fast typing produces single request
+            _autocompletionTimer->start();
             _textChanged = false;
         }
     }
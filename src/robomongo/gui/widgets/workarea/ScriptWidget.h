@@ -4,6 +4,7 @@
 QT_BEGIN_NAMESPACE
 class QLabel;
 class QCompleter;
+class QTimer;
 QT_END_NAMESPACE
 
 #include "robomongo/core/domain/MongoShellResult.h"
@@ -50,6 +51,8 @@ namespace Robomongo
         Q_OBJECT
 
     public:
+        enum { autocompletionDelayMs = 150 };
+
         ScriptWidget(MongoShell *shell, QueryWidget* parent);
 
         /**
@@ -66,7 +69,6 @@ namespace Robomongo
         void setCurrentDatabase(const std::string &database, bool isValid = true);
         void setCurrentServer(const std::string &address, bool isValid = true);
         void showAutocompletion(const QStringList &list, const QString &prefix);
-        void showAutocompletion();
         void hideAutocompletion();
         bool getDisableTextAndCursorNotifications() { return _disableTextAndCursorNotifications; }
         void setDisableTextAndCursorNotifications(const bool value) { _disableTextAndCursorNotifications = value; }
@@ -77,6 +79,7 @@ namespace Robomongo
         void textChanged();
 
     public Q_SLOTS:
+        void showAutocompletion();
         void setText(const QString &text);
         void ui_queryLinesCountChanged();
 
@@ -114,6 +117,9 @@ namespace Robomongo
         FindFrame *_queryText;
         TopStatusBar *_topStatusBar;
         QCompleter *_completer;
+
+        // Autocompletion is requested only after user stops typing for a short while
+        QTimer *_autocompletionTimer;
         MongoShell *_shell;
         AutoCompletionInfo _currentAutoCompletionInfo;
 